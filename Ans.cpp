@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Ans.hpp"
+
+namespace Ans
+{
+    namespace
+    {
+        unsigned BitLength(size_t aValue)
+        {
+            unsigned length = 0;
+            for (; aValue; aValue >>= 1)
+            {
+                ++length;
+            }
+            return length;
+        }
+
+        // Spreads symbols over the table, so that states of each symbol are
+        // far apart. Step is odd, so it visits every state of the table.
+        std::vector<uint8_t> Spread(const TCounts& aCounts, unsigned aTableLog)
+        {
+            if (aTableLog < MinTableLog || aTableLog > MaxTableLog)
+            {
+                throw std::runtime_error("Ans: Invalid table size.");
+            }
+
+            const size_t size = size_t{1} << aTableLog;
+            const size_t mask = size - 1;
+            const size_t step = (size >> 1) + (size >> 3) + 3;
+
+            size_t total = 0;
+            for (auto count : aCounts)
+            {
+                total += count;
+            }
+
+            if (total != size)
+            {
+                throw std::runtime_error("Ans: Invalid counts.");
+            }
+
+            std::vector<uint8_t> symbols(size);
+
+            size_t position = 0;
+            for (size_t symbol = 0; symbol < aCounts.size(); ++symbol)
+            {
+                for (unsigned i = 0; i < aCounts[symbol]; ++i)
+                {
+                    symbols[position] = static_cast<uint8_t>(symbol);
+                    position = (position + step) & mask;
+                }
+            }
+
+            return symbols;
+        }
+
+        // Packs bits least significant first through 64-bit accumulator.
+        class BitsPacker
+        {
+        public:
+            explicit BitsPacker(TBytes& aOutput)
+              : mOutput{aOutput}
+            {
+            }
+
+            void Write(uint32_t aValue, unsigned aLength)
+            {
+                mBits |= uint64_t{aValue} << mCount;
+                mCount += aLength;
+
+                while (mCount >= 8)
+                {
+                    mOutput.push_back(static_cast<uint8_t>(mBits));
+                    mBits >>= 8;
+                    mCount -= 8;
+                }
+            }
+
+            // Returns count of unused bits of the last byte.
+            uint8_t Finish()
+            {
+                if (mCount == 0)
+                {
+                    return 0;
+                }
+
+                mOutput.push_back(static_cast<uint8_t>(mBits));
+                return static_cast<uint8_t>(8 - mCount);
+            }
+
+        private:
+            TBytes& mOutput;
+            uint64_t mBits{0};
+            unsigned mCount{0};
+        };
+    }
+
+    unsigned TableLog(size_t aSize, size_t aSymbols)
+    {
+        unsigned log = 11;
+
+        // Short data can't make use of all states.
+        auto bits = BitLength(aSize > 1 ? aSize - 1 : 1);
+        if (bits > 2)
+        {
+            log = std::min(log, bits - 2);
+        }
+
+        log = std::max(log, BitLength(aSymbols) + 1);
+        return std::min(std::max(log, MinTableLog), MaxTableLog);
+    }
+
+    TCounts Normalize(const Huffman::THistogram& aHistogram, size_t aSize, unsigned aTableLog)
+    {
+        const size_t size = size_t{1} << aTableLog;
+
+        TCounts counts{};
+        size_t total = 0;
+        size_t largest = 0;
+
+        for (size_t symbol = 0; symbol < aHistogram.size(); ++symbol)
+        {
+            if (aHistogram[symbol] == 0)
+            {
+                continue;
+            }
+
+            auto count = std::max<uint64_t>(1, uint64_t{aHistogram[symbol]} * size / aSize);
+            counts[symbol] = static_cast<uint16_t>(count);
+            total += count;
+
+            if (aHistogram[symbol] > aHistogram[largest])
+            {
+                largest = symbol;
+            }
+        }
+
+        if (total == 0)
+        {
+            throw std::invalid_argument("Ans: No symbols.");
+        }
+
+        // Rounding down leaves some of the table to the most frequent symbol.
+        if (total <= size)
+        {
+            counts[largest] = static_cast<uint16_t>(counts[largest] + size - total);
+            return counts;
+        }
+
+        // Rare symbols, raised to one, overflow the table, which is taken
+        // back from the largest counts, as it costs them the least.
+        for (; total > size; --total)
+        {
+            auto most = std::max_element(counts.begin(), counts.end());
+            if (*most <= 1)
+            {
+                throw std::invalid_argument("Ans: Table is too small.");
+            }
+            --*most;
+        }
+
+        return counts;
+    }
+
+    // Occurrence n of symbol, counting from its count, is state n in range
+    // [count, 2 * count), which decoder turns into one of table states.
+    Encoder::Encoder(const TCounts& aCounts, unsigned aTableLog)
+      : mTableLog{aTableLog}
+      , mCounts(aCounts)
+    {
+        const auto symbols = Spread(aCounts, aTableLog);
+        mStates.resize(symbols.size());
+
+        uint32_t start = 0;
+        for (size_t symbol = 0; symbol < aCounts.size(); ++symbol)
+        {
+            mStarts[symbol] = start;
+            start += aCounts[symbol];
+
+            mShifts[symbol] = aCounts[symbol] ? static_cast<uint8_t>(aTableLog + 1 - BitLength(aCounts[symbol])) : 0;
+        }
+
+        auto next = mStarts;
+        for (size_t state = 0; state < symbols.size(); ++state)
+        {
+            mStates[next[symbols[state]]++] = static_cast<uint16_t>(state + symbols.size());
+        }
+    }
+
+    void Encoder::Encode(const uint8_t* aData, size_t aSize, Encoded& aOutput) const
+    {
+        const uint32_t size = uint32_t{1} << mTableLog;
+
+        aOutput.Bits.clear();
+        aOutput.Bits.reserve(aSize / 2);
+
+        BitsPacker bits{aOutput.Bits};
+
+        // States run in [size, 2 * size), both coders start at the lowest.
+        uint32_t states[2] = {size, size};
+
+        for (size_t i = aSize; i-- > 0;)
+        {
+            auto& state = states[i & 1];
+
+            const auto symbol = aData[i];
+            const uint32_t count = mCounts[symbol];
+            const unsigned shift = mShifts[symbol];
+
+            auto length = state >= (count << shift) ? shift : shift - 1;
+            bits.Write(state & ((1u << length) - 1), length);
+
+            state = mStates[mStarts[symbol] + (state >> length) - count];
+        }
+
+        aOutput.Padding = bits.Finish();
+        aOutput.States[0] = static_cast<uint16_t>(states[0] - size);
+        aOutput.States[1] = static_cast<uint16_t>(states[1] - size);
+    }
+
+    Decoder::Decoder(const TCounts& aCounts, unsigned aTableLog)
+      : mTableLog{aTableLog}
+    {
+        const auto symbols = Spread(aCounts, aTableLog);
+        mTable.resize(symbols.size());
+
+        TCounts next(aCounts);
+        for (size_t state = 0; state < symbols.size(); ++state)
+        {
+            const auto symbol = symbols[state];
+            const size_t occurrence = next[symbol]++;
+
+            const auto bits = aTableLog + 1 - BitLength(occurrence);
+            mTable[state] = Entry{static_cast<uint16_t>((occurrence << bits) - symbols.size()), symbol,
+                                  static_cast<uint8_t>(bits)};
+        }
+    }
+
+    bool Decoder::Decode(const uint8_t* aData, size_t aSize, uint8_t aPadding, const uint16_t* aStates,
+                         uint8_t* aOutput, size_t aCount) const
+    {
+        const size_t size = mTable.size();
+        if (aStates[0] >= size || aStates[1] >= size || aPadding > 7 || (aSize == 0 && aPadding))
+        {
+            return false;
+        }
+
+        size_t states[2] = {aStates[0], aStates[1]};
+        auto position = aSize * 8 - aPadding;
+
+        for (size_t i = 0; i < aCount; ++i)
+        {
+            auto& state = states[i & 1];
+            const auto& entry = mTable[state];
+
+            aOutput[i] = entry.Symbol;
+
+            if (entry.Bits > position)
+            {
+                return false;
+            }
+            position -= entry.Bits;
+
+            // Bits are packed from the lowest one of each byte.
+            const auto data = aData + (position >> 3);
+
+            uint64_t word = 0;
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            std::memcpy(&word, data, sizeof(word));
+#else
+            for (int j = 7; j >= 0; --j)
+            {
+                word = (word << 8) | data[j];
+            }
+#endif
+
+            state = entry.Base + ((word >> (position & 7)) & ((uint64_t{1} << entry.Bits) - 1));
+        }
+
+        return position == 0 && states[0] == 0 && states[1] == 0;
+    }
+}
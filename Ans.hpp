@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "HuffmanTree.hpp"
+
+namespace Ans
+{
+    using TBytes = std::vector<uint8_t>;
+    using TCounts = std::array<uint16_t, 256>;
+
+    static constexpr unsigned MinTableLog = 5;
+    static constexpr unsigned MaxTableLog = 12;
+
+    // Decoder reads words, which may take this many bytes past the end of data.
+    static constexpr size_t Slack = 8;
+
+    // Table of 2K states, or less for short data, but two states per symbol at least.
+    unsigned TableLog(size_t aSize, size_t aSymbols);
+
+    // Scales counts to add up to 1 << aTableLog, each present symbol keeps one.
+    TCounts Normalize(const Huffman::THistogram& aHistogram, size_t aSize, unsigned aTableLog);
+
+    // Bits of data and final states of two interleaved coders, each of them
+    // codes every other symbol. Last byte has Padding high bits unused.
+    struct Encoded
+    {
+        TBytes Bits;
+        uint8_t Padding{0};
+        uint16_t States[2]{};
+    };
+
+    // Table based asymmetric numeral system (tANS). Symbols are coded from the
+    // last, so decoder reads bits from the end back and gives symbols in order.
+    class Encoder
+    {
+    public:
+        Encoder(const TCounts& aCounts, unsigned aTableLog);
+
+        void Encode(const uint8_t* aData, size_t aSize, Encoded& aOutput) const;
+
+    private:
+        unsigned mTableLog;
+        TCounts mCounts;
+
+        // Each symbol's next states, in order of its occurrences in table.
+        std::array<uint32_t, 256> mStarts;
+        std::array<uint8_t, 256> mShifts;
+        std::vector<uint16_t> mStates;
+    };
+
+    class Decoder
+    {
+    public:
+        // Throws if counts don't add up to the table.
+        Decoder(const TCounts& aCounts, unsigned aTableLog);
+
+        // Data is followed by Slack readable bytes. Returns false if bits
+        // run out, are left or don't end at initial states.
+        bool Decode(const uint8_t* aData, size_t aSize, uint8_t aPadding, const uint16_t* aStates, uint8_t* aOutput,
+                    size_t aCount) const;
+
+    private:
+        struct Entry
+        {
+            uint16_t Base;
+            uint8_t Symbol;
+            uint8_t Bits;
+        };
+
+        unsigned mTableLog;
+        std::vector<Entry> mTable;
+    };
+}
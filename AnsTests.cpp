@@ -0,0 +1,141 @@
+#include <random>
+
+#include "Ans.hpp"
+#include "TestsBase.hpp"
+
+namespace
+{
+    Huffman::THistogram Histogram(const Ans::TBytes& aData)
+    {
+        Huffman::THistogram histogram{};
+        for (auto byte : aData)
+        {
+            histogram[byte]++;
+        }
+        return histogram;
+    }
+
+    Ans::TBytes RoundTrip(const Ans::TBytes& aData, Ans::Encoded& aEncoded)
+    {
+        size_t symbols = 0;
+        for (auto count : Histogram(aData))
+        {
+            symbols += count != 0;
+        }
+
+        const auto log = Ans::TableLog(aData.size(), symbols);
+        const auto counts = Ans::Normalize(Histogram(aData), aData.size(), log);
+
+        Ans::Encoder{counts, log}.Encode(aData.data(), aData.size(), aEncoded);
+
+        auto bits = aEncoded.Bits;
+        bits.resize(bits.size() + Ans::Slack);
+
+        Ans::TBytes output(aData.size());
+        EXPECT_TRUE(Ans::Decoder(counts, log).Decode(bits.data(), aEncoded.Bits.size(), aEncoded.Padding,
+                                                     aEncoded.States, output.data(), output.size()));
+        return output;
+    }
+}
+
+TEST(Ans, ShouldNormalizeCountsToTable)
+{
+    Huffman::THistogram histogram{};
+    histogram['a'] = 900;
+    histogram['b'] = 99;
+    histogram['c'] = 1;
+
+    auto counts = Ans::Normalize(histogram, 1000, 5);
+    EXPECT_EQ(28, counts['a']);
+    EXPECT_EQ(3, counts['b']);
+    EXPECT_EQ(1, counts['c']);
+
+    // Every present symbol keeps a state, which is taken from frequent ones.
+    Huffman::THistogram rare{};
+    for (size_t symbol = 0; symbol < 20; ++symbol)
+    {
+        rare[symbol] = symbol == 0 ? 10000 : 1;
+    }
+
+    counts = Ans::Normalize(rare, 10019, 5);
+    EXPECT_EQ(13, counts[0]);
+    EXPECT_EQ(1, counts[19]);
+
+    for (size_t symbol = 20; symbol < 40; ++symbol)
+    {
+        rare[symbol] = 1;
+    }
+    EXPECT_THROW(Ans::Normalize(rare, 10039, 5), std::invalid_argument);
+}
+
+TEST(Ans, ShouldDecodeEncodedData)
+{
+    std::mt19937 random{11};
+
+    for (int i = 0; i < 40; ++i)
+    {
+        Ans::TBytes data(1 + random() % 30000);
+        const auto alphabet = 1 + random() % 256;
+        for (auto& byte : data)
+        {
+            // Skewed towards small symbols.
+            byte = static_cast<uint8_t>(random() % (1 + random() % alphabet));
+        }
+
+        Ans::Encoded encoded;
+        ASSERT_EQ(data, RoundTrip(data, encoded));
+    }
+}
+
+TEST(Ans, ShouldBeatWholeBitsOnSkewedData)
+{
+    std::mt19937 random{5};
+
+    // Probabilities of 0.9 and 0.1 take 0.47 bits per symbol, Huffman takes 1.
+    Ans::TBytes data(100000);
+    for (auto& byte : data)
+    {
+        byte = random() % 10 ? 'a' : 'b';
+    }
+
+    Ans::Encoded encoded;
+    EXPECT_EQ(data, RoundTrip(data, encoded));
+    EXPECT_LT(encoded.Bits.size(), data.size() / 8 * 6 / 10);
+
+    // Single symbol takes no bits at all.
+    Ans::TBytes same(1000, 'x');
+    EXPECT_EQ(same, RoundTrip(same, encoded));
+    EXPECT_TRUE(encoded.Bits.empty());
+}
+
+TEST(Ans, ShouldRejectDamagedData)
+{
+    Ans::TCounts counts{};
+    counts['a'] = 20;
+    counts['b'] = 12;
+
+    EXPECT_THROW(Ans::Decoder(counts, 6), std::runtime_error);
+    EXPECT_THROW(Ans::Decoder(counts, 20), std::runtime_error);
+
+    Ans::TBytes data(1000);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = i % 3 ? 'a' : 'b';
+    }
+
+    Ans::Encoded encoded;
+    Ans::Encoder{counts, 5}.Encode(data.data(), data.size(), encoded);
+
+    auto bits = encoded.Bits;
+    bits.resize(bits.size() + Ans::Slack);
+
+    Ans::TBytes output(data.size());
+    Ans::Decoder decoder{counts, 5};
+
+    EXPECT_FALSE(decoder.Decode(bits.data(), encoded.Bits.size() - 1, encoded.Padding, encoded.States, output.data(),
+                                output.size()));
+
+    bits[0] ^= 1;
+    EXPECT_FALSE(decoder.Decode(bits.data(), encoded.Bits.size(), encoded.Padding, encoded.States, output.data(),
+                                output.size()));
+}
@@ -1,17 +1,570 @@
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "Application.hpp"
+#include "Counters.hpp"
+#include "Daemon.hpp"
 #include "Filesystem.hpp"
+#include "Pool.hpp"
+#include "Trace.hpp"
+#include "Uring.hpp"
+
+struct Options
+{
+    std::vector<std::string> Tables;
+    std::vector<std::string> Files;
+
+    double Sample{1.0};
+    unsigned Threads{1};
+
+    // Memory budget in MiB, none if zero.
+    size_t Memory{0};
+
+    bool Uring{false};
+    bool Direct{false};
+    Uring::Options Pipeline;
+
+    bool Blocks{false};
+    size_t BlockSize{0};
+    bool Bwt{false};
+    bool Split{false};
+    bool Lz{false};
+    unsigned LzDepth{0};
+    size_t LzWindow{0};
+    std::string Entropy;
+
+    bool Batch{false};
+    unsigned Jobs{0};
+
+    bool Counters{false};
+    std::string Trace;
+
+    std::string Serve;
+    std::string Daemon;
+    bool Stats{false};
+};
+
+// One file of batch mode.
+struct Job
+{
+    std::string Input;
+    std::string Output;
+
+    size_t InputSize{0};
+    size_t OutputSize{0};
+    double Seconds{0.0};
+
+    std::string Error;
+};
 
 auto Usage(const char* aToolName)
 {
-    std::cout << "Usage: " << aToolName << " input output\n";
+    std::cout << "Usage: " << aToolName << " [--table table-file]... [--sample fraction] [--threads count] [--memory MiB] [--uring [--direct]] [--counters] [--trace trace-file] input output\n"
+              << "       " << aToolName << " --blocks [--block-size bytes] [--split] [--bwt] [--lz [--lz-depth count] [--lz-window bytes]] [--entropy huffman|ans|best] [options] input output\n"
+              << "       " << aToolName << " [options] --batch [--jobs count] (list-file | input-dir output-dir)\n"
+              << "       " << aToolName << " [--table table-file]... [--threads count] [--jobs count] --serve socket\n"
+              << "       " << aToolName << " --daemon socket (--stats | input output)\n";
     return 1;
 }
 
+bool Parse(int argc, char** argv, Options& aOptions)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg{argv[i]};
+
+        if (arg == "--table" && i + 1 < argc)
+        {
+            aOptions.Tables.emplace_back(argv[++i]);
+        }
+        else if (arg == "--sample" && i + 1 < argc)
+        {
+            char* end = nullptr;
+            aOptions.Sample = std::strtod(argv[++i], &end);
+
+            if (*end || !(aOptions.Sample > 0.0 && aOptions.Sample <= 1.0))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            char* end = nullptr;
+            auto threads = std::strtoul(argv[++i], &end, 10);
+
+            if (*end || threads == 0 || threads > 1024)
+            {
+                return false;
+            }
+            aOptions.Threads = static_cast<unsigned>(threads);
+        }
+        else if (arg == "--memory" && i + 1 < argc)
+        {
+            char* end = nullptr;
+            auto memory = std::strtoull(argv[++i], &end, 10);
+
+            if (*end || memory == 0 || memory > (1u << 20))
+            {
+                return false;
+            }
+            aOptions.Memory = static_cast<size_t>(memory);
+        }
+        else if (arg == "--jobs" && i + 1 < argc)
+        {
+            char* end = nullptr;
+            auto jobs = std::strtoul(argv[++i], &end, 10);
+
+            if (*end || jobs == 0 || jobs > 1024)
+            {
+                return false;
+            }
+            aOptions.Jobs = static_cast<unsigned>(jobs);
+        }
+        else if (arg == "--block-size" && i + 1 < argc)
+        {
+            char* end = nullptr;
+            auto size = std::strtoull(argv[++i], &end, 10);
+
+            if (*end || size == 0 || size > (1u << 30))
+            {
+                return false;
+            }
+            aOptions.BlockSize = static_cast<size_t>(size);
+        }
+        else if (arg == "--blocks")
+        {
+            aOptions.Blocks = true;
+        }
+        else if (arg == "--bwt")
+        {
+            aOptions.Bwt = true;
+        }
+        else if (arg == "--split")
+        {
+            aOptions.Split = true;
+        }
+        else if (arg == "--lz")
+        {
+            aOptions.Lz = true;
+        }
+        else if (arg == "--lz-depth" && i + 1 < argc)
+        {
+            char* end = nullptr;
+            auto depth = std::strtoul(argv[++i], &end, 10);
+
+            if (*end || depth == 0 || depth > 4096)
+            {
+                return false;
+            }
+            aOptions.LzDepth = static_cast<unsigned>(depth);
+        }
+        else if (arg == "--entropy" && i + 1 < argc)
+        {
+            aOptions.Entropy = argv[++i];
+
+            if (aOptions.Entropy != "huffman" && aOptions.Entropy != "ans" && aOptions.Entropy != "best")
+            {
+                return false;
+            }
+        }
+        else if (arg == "--lz-window" && i + 1 < argc)
+        {
+            char* end = nullptr;
+            auto window = std::strtoull(argv[++i], &end, 10);
+
+            if (*end || window == 0 || window > Lz::MaxWindow || (window & (window - 1)))
+            {
+                return false;
+            }
+            aOptions.LzWindow = static_cast<size_t>(window);
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            aOptions.Trace = argv[++i];
+        }
+        else if (arg == "--serve" && i + 1 < argc)
+        {
+            aOptions.Serve = argv[++i];
+        }
+        else if (arg == "--daemon" && i + 1 < argc)
+        {
+            aOptions.Daemon = argv[++i];
+        }
+        else if (arg == "--stats")
+        {
+            aOptions.Stats = true;
+        }
+        else if (arg == "--counters")
+        {
+            aOptions.Counters = true;
+        }
+        else if (arg == "--batch")
+        {
+            aOptions.Batch = true;
+        }
+        else if (arg == "--uring")
+        {
+            aOptions.Uring = true;
+        }
+        else if (arg == "--direct")
+        {
+            aOptions.Direct = true;
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            return false;
+        }
+        else
+        {
+            aOptions.Files.push_back(arg);
+        }
+    }
+
+    // Server lives until stopped, so it has nothing to report at exit.
+    if (!aOptions.Serve.empty())
+    {
+        return aOptions.Files.empty() && aOptions.Daemon.empty() && !aOptions.Batch && !aOptions.Stats &&
+               !aOptions.Counters && aOptions.Trace.empty();
+    }
+
+    if (!aOptions.Daemon.empty())
+    {
+        return aOptions.Files.size() == (aOptions.Stats ? 0 : 2) && !aOptions.Batch && !aOptions.Jobs &&
+               !aOptions.Counters && aOptions.Trace.empty();
+    }
+
+    if (aOptions.Stats)
+    {
+        return false;
+    }
+
+    if ((aOptions.BlockSize || aOptions.Split || aOptions.Bwt || aOptions.Lz || !aOptions.Entropy.empty()) &&
+        !aOptions.Blocks)
+    {
+        return false;
+    }
+
+    if ((aOptions.LzDepth || aOptions.LzWindow) && !aOptions.Lz)
+    {
+        return false;
+    }
+
+    if (aOptions.Direct && !aOptions.Uring)
+    {
+        return false;
+    }
+
+    // Blocks carry their own tables, shared ones don't apply.
+    if (aOptions.Blocks && !aOptions.Tables.empty())
+    {
+        return false;
+    }
+
+    // Counters are per process, so they can't tell files of batch apart.
+    if (aOptions.Batch)
+    {
+        return (aOptions.Files.size() == 1 || aOptions.Files.size() == 2) && !aOptions.Counters;
+    }
+
+    return aOptions.Files.size() == 2 && !aOptions.Jobs;
+}
+
+auto TrainUsage(const char* aToolName)
+{
+    std::cout << "Usage: " << aToolName << " [--memory MiB] [--trace trace-file] corpus table\n";
+    return 1;
+}
+
+// Training reads whole corpus into one table, so options of coding,
+// batches and daemon don't apply to it.
+bool ParseTrain(int argc, char** argv, Options& aOptions)
+{
+    return Parse(argc, argv, aOptions) && aOptions.Files.size() == 2 && aOptions.Tables.empty() &&
+           aOptions.Sample == 1.0 && aOptions.Threads == 1 && !aOptions.Uring && !aOptions.Blocks &&
+           !aOptions.Batch && !aOptions.Jobs && aOptions.Serve.empty() && aOptions.Daemon.empty() &&
+           !aOptions.Counters;
+}
+
+// Reads and writes are traced too, if tracing is on.
+void Run(Application::TRoutine aRoutine, IStorage::Input& aInput, IStorage::Output& aOutput,
+         const Processor::Config& aConfig)
+{
+    if (aConfig.Trace)
+    {
+        Trace::Input input{aInput, *aConfig.Trace};
+        Trace::Output output{aOutput, *aConfig.Trace};
+
+        aRoutine(input, output, aConfig);
+    }
+    else
+    {
+        aRoutine(aInput, aOutput, aConfig);
+    }
+}
+
+void Process(Application::TRoutine aRoutine, const std::string& aInput, const std::string& aOutput,
+             const Options& aOptions, const Processor::Config& aConfig)
+{
+    // Fall back to regular streams, if kernel has no io_uring.
+    if (aOptions.Uring && Uring::Available())
+    {
+        auto io = aOptions.Pipeline;
+        io.Direct = aOptions.Direct;
+
+        Budget::Lease requests{aConfig.Memory, 2 * io.Depth * io.BlockSize};
+
+        Uring::Reader reader{aInput, io};
+        Uring::Writer writer{aOutput, io};
+
+        Run(aRoutine, reader, writer, aConfig);
+        writer.Close();
+    }
+    else
+    {
+        Filesystem::Reader reader{aInput};
+        Filesystem::Writer writer{aOutput};
+
+        Run(aRoutine, reader, writer, aConfig);
+    }
+}
+
+// List file holds a pair of input and output names per line,
+// otherwise each file of input directory goes to output one.
+std::vector<Job> MakeJobs(const Options& aOptions)
+{
+    std::vector<Job> jobs;
+
+    const auto& input = aOptions.Files[0];
+    const bool directories = aOptions.Files.size() == 2;
+
+    if (Filesystem::IsDirectory(input) != directories)
+    {
+        throw std::runtime_error(directories ? "Application: " + input + " is not a directory."
+                                             : "Application: No output directory for " + input + ".");
+    }
+
+    if (directories && !Filesystem::IsDirectory(aOptions.Files[1]))
+    {
+        throw std::runtime_error("Application: " + aOptions.Files[1] + " is not a directory.");
+    }
+
+    if (directories)
+    {
+        for (const auto& name : Filesystem::List(aOptions.Files[0]))
+        {
+            Job job;
+            job.Input = aOptions.Files[0] + "/" + name;
+            job.Output = aOptions.Files[1] + "/" + name;
+            jobs.push_back(job);
+        }
+    }
+    else
+    {
+        std::ifstream list{aOptions.Files[0]};
+        if (!list)
+        {
+            throw std::runtime_error("Application: Can't open list file.");
+        }
+
+        std::string line;
+        while (std::getline(list, line))
+        {
+            Job job;
+            std::istringstream pair{line};
+            if (!(pair >> job.Input))
+            {
+                continue;
+            }
+
+            if (!(pair >> job.Output))
+            {
+                throw std::runtime_error("Application: No output for " + job.Input + ".");
+            }
+            jobs.push_back(job);
+        }
+    }
+
+    for (auto& job : jobs)
+    {
+        job.InputSize = Filesystem::SizeOf(job.Input);
+    }
+
+    return jobs;
+}
+
+double Throughput(size_t aSize, double aSeconds)
+{
+    return aSeconds > 0.0 ? aSize / aSeconds / (1024 * 1024) : 0.0;
+}
+
+int RunBatch(Application::TRoutine aRoutine, const Options& aOptions, const Processor::Config& aConfig)
+{
+    auto jobs = MakeJobs(aOptions);
+
+    // Largest files go first, so small ones fill the gaps at the end.
+    std::vector<size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&jobs](size_t aLeft, size_t aRight) {
+        return jobs[aLeft].InputSize > jobs[aRight].InputSize;
+    });
+
+    std::vector<Pool::TJob> tasks;
+    tasks.reserve(jobs.size());
+
+    for (auto index : order)
+    {
+        auto& job = jobs[index];
+        tasks.push_back([&job, aRoutine, &aOptions, &aConfig]() {
+            auto start = std::chrono::steady_clock::now();
+            try
+            {
+                Trace::Span span{aConfig.Trace, "file", "batch"};
+                Process(aRoutine, job.Input, job.Output, aOptions, aConfig);
+            }
+            catch (std::exception& e)
+            {
+                job.Error = e.what();
+            }
+
+            job.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            job.OutputSize = Filesystem::SizeOf(job.Output);
+        });
+    }
+
+    auto threads = aOptions.Jobs ? aOptions.Jobs : std::max(1u, std::thread::hardware_concurrency());
+
+    // Fewer files are coded at once, rather than more than budget allows.
+    if (aConfig.Memory)
+    {
+        auto footprint = Processor::Footprint(aConfig, aOptions.Uring ? &aOptions.Pipeline : nullptr);
+        threads = static_cast<unsigned>(
+            std::max<size_t>(1, std::min<size_t>(threads, aConfig.Memory->Limit() / footprint)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Pool::WorkStealing{threads}.Run(std::move(tasks));
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t totalInput = 0;
+    size_t totalOutput = 0;
+    int result = 0;
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (const auto& job : jobs)
+    {
+        if (!job.Error.empty())
+        {
+            std::cout << "FAIL " << job.Input << ": " << job.Error << "\n";
+            result = 1;
+            continue;
+        }
+
+        std::cout << "PASS " << job.Input << " -> " << job.Output << ": " << job.InputSize << " -> "
+                  << job.OutputSize << " bytes, " << Throughput(job.InputSize, job.Seconds) << " MiB/s\n";
+
+        totalInput += job.InputSize;
+        totalOutput += job.OutputSize;
+    }
+
+    std::cout << "== TOTAL " << jobs.size() << " files, " << threads << " threads: " << totalInput << " -> "
+              << totalOutput << " bytes, " << seconds << " s, " << Throughput(totalInput, seconds) << " MiB/s"
+              << std::endl;
+
+    return result;
+}
+
+Daemon::Server* ActiveServer{nullptr};
+
+void StopServer(int)
+{
+    ActiveServer->Stop();
+}
+
+int RunServer(const Options& aOptions, const Processor::Config& aConfig)
+{
+    Daemon::Options options;
+    if (aOptions.Jobs)
+    {
+        options.Threads = aOptions.Jobs;
+    }
+
+    // Each worker keeps its buffers and codes a request at a time.
+    if (aConfig.Memory)
+    {
+        auto footprint = Processor::Footprint(aConfig) + 2 * options.BufferSize;
+        options.Threads = static_cast<unsigned>(
+            std::max<size_t>(1, std::min<size_t>(options.Threads, aConfig.Memory->Limit() / footprint)));
+    }
+
+    Daemon::Server server{aOptions.Serve, aConfig, options};
+
+    ActiveServer = &server;
+    std::signal(SIGINT, StopServer);
+    std::signal(SIGTERM, StopServer);
+
+    std::cout << "Serving on " << aOptions.Serve << " with " << options.Threads << " workers" << std::endl;
+    server.Run();
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    ActiveServer = nullptr;
+
+    std::cout << server.Latencies().Report() << std::endl;
+    return 0;
+}
+
+// Files are opened by daemon, which may run in another directory.
+int RunClient(Application::TRoutine aRoutine, const Options& aOptions)
+{
+    Daemon::Client client{aOptions.Daemon};
+
+    if (aOptions.Stats)
+    {
+        std::cout << client.Stats() << std::endl;
+        return 0;
+    }
+
+    Daemon::Operation operation;
+    if (aRoutine == static_cast<Application::TRoutine>(Processor::Encode))
+    {
+        operation = Daemon::Operation::Encode;
+    }
+    else if (aRoutine == static_cast<Application::TRoutine>(Processor::Decode))
+    {
+        operation = Daemon::Operation::Decode;
+    }
+    else
+    {
+        throw std::runtime_error("Application: Daemon serves only encoding and decoding.");
+    }
+
+    client.Process(operation, Filesystem::Absolute(aOptions.Files[0]), Filesystem::Absolute(aOptions.Files[1]));
+    return 0;
+}
+
 int Application::Run(TRoutine aRoutine, int argc, char** argv)
 {
-    if (argc != 3)
+    Options options;
+    if (aRoutine == static_cast<TRoutine>(Processor::Train))
+    {
+        if (!ParseTrain(argc, argv, options))
+        {
+            return TrainUsage(argv[0]);
+        }
+    }
+    else if (!Parse(argc, argv, options))
     {
         return Usage(argv[0]);
     }
@@ -20,10 +573,118 @@ int Application::Run(TRoutine aRoutine, int argc, char** argv)
     {
         std::ios_base::sync_with_stdio(false);
 
-        Filesystem::Reader reader{argv[1]};
-        Filesystem::Writer writer{argv[2]};
+        if (!options.Daemon.empty())
+        {
+            return RunClient(aRoutine, options);
+        }
+
+        Processor::Config config;
+        config.Sample.Fraction = options.Sample;
+        config.Threads = options.Threads;
+
+        Huffman::SharedTables tables;
+        for (const auto& name : options.Tables)
+        {
+            Filesystem::Reader reader{name};
+            tables.Add(Huffman::SharedTable::Load(reader));
+        }
+
+        if (!tables.Empty())
+        {
+            config.Tables = &tables;
+        }
+
+        Stream::Options blocks;
+        Lz::Options matches;
+        if (options.Blocks)
+        {
+            if (options.BlockSize)
+            {
+                blocks.BlockSize = options.BlockSize;
+            }
+            blocks.Transform = options.Bwt;
+            blocks.Split = options.Split;
+
+            if (options.Entropy == "ans")
+            {
+                blocks.Entropy = Stream::Coder::Ans;
+            }
+            else if (options.Entropy == "best")
+            {
+                blocks.Entropy = Stream::Coder::Best;
+            }
+
+            if (options.Lz)
+            {
+                if (options.LzDepth)
+                {
+                    matches.Depth = options.LzDepth;
+                }
+                if (options.LzWindow)
+                {
+                    matches.Window = options.LzWindow;
+                }
+                blocks.Matches = &matches;
+            }
+
+            config.Blocks = &blocks;
+        }
+
+        std::unique_ptr<Budget::Tracker> memory;
+        if (options.Memory)
+        {
+            memory.reset(new Budget::Tracker{options.Memory * 1024 * 1024});
+            Processor::Fit(memory->Limit(), config, options.Blocks ? &blocks : nullptr,
+                           options.Uring ? &options.Pipeline : nullptr);
+            config.Memory = memory.get();
+        }
+
+        std::unique_ptr<Trace::Recorder> recorder;
+        if (!options.Trace.empty())
+        {
+            recorder.reset(new Trace::Recorder);
+            config.Trace = recorder.get();
+        }
+
+        std::unique_ptr<Counters::Profile> profile;
+        if (options.Counters)
+        {
+            profile.reset(new Counters::Profile);
+            config.Profile = profile.get();
+        }
+
+        auto result = 0;
+        if (!options.Serve.empty())
+        {
+            result = RunServer(options, config);
+        }
+        else if (options.Batch)
+        {
+            result = RunBatch(aRoutine, options, config);
+        }
+        else
+        {
+            Process(aRoutine, options.Files[0], options.Files[1], options, config);
+        }
+
+        if (profile)
+        {
+            profile->Report(std::cout);
+
+            if (memory)
+            {
+                std::cout << "Memory: " << memory->Peak() / 1024 << " of " << memory->Limit() / 1024 << " KiB"
+                          << std::endl;
+            }
+        }
+
+        if (recorder)
+        {
+            std::ofstream trace{options.Trace};
+            recorder->Write(trace);
+        }
 
-        aRoutine(reader, writer);
+        return result;
     }
     catch (std::exception& e)
     {
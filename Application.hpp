@@ -1,8 +1,9 @@
 #include "Interfaces.hpp"
+#include "Processor.hpp"
 
 namespace Application
 {
-    using TRoutine = void(*)(IStorage::Input&, IStorage::Output&);
+    using TRoutine = void(*)(IStorage::Input&, IStorage::Output&, const Processor::Config&);
 
     int Run(TRoutine aRoutine, int aArgc, char** aArgv);
 }
@@ -0,0 +1,116 @@
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "Container.hpp"
+#include "Filesystem.hpp"
+
+namespace
+{
+    auto Usage(const char* aToolName)
+    {
+        std::cout << "Usage: " << aToolName << " [--own-tables] create archive file...\n"
+                  << "       " << aToolName << " list archive\n"
+                  << "       " << aToolName << " extract archive member output\n";
+        return 1;
+    }
+
+    int Create(const std::string& aArchive, const Container::TNames& aNames, const Container::Options& aOptions)
+    {
+        // Missing input would be read as empty member, so it fails before
+        // archive is written.
+        for (const auto& name : aNames)
+        {
+            if (!std::ifstream{name})
+            {
+                throw std::runtime_error("Archive: Can't open " + name + ".");
+            }
+        }
+
+        Filesystem::Writer writer{aArchive};
+
+        Container::Create(aNames, [](const std::string& aName) {
+            return std::unique_ptr<IStorage::Input>{new Filesystem::Reader{aName}};
+        }, writer, aOptions);
+
+        return 0;
+    }
+
+    int List(const std::string& aArchive)
+    {
+        Filesystem::Reader reader{aArchive};
+        Container::Reader archive{reader};
+
+        for (size_t i = 0; i < archive.Count(); ++i)
+        {
+            const auto& member = archive.Get(i);
+            std::cout << member.Size << "\t" << member.EncodedSize << "\t" << member.Name << "\n";
+        }
+
+        return 0;
+    }
+
+    int Extract(const std::string& aArchive, const std::string& aMember, const std::string& aOutput)
+    {
+        Filesystem::Reader reader{aArchive};
+        Container::Reader archive{reader};
+
+        auto index = archive.Find(aMember);
+        if (index == archive.Count())
+        {
+            std::cout << "Fail: No such member " << aMember << std::endl;
+            return 1;
+        }
+
+        Filesystem::Writer writer{aOutput};
+        archive.Extract(index, writer);
+
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Container::Options options;
+
+    int i = 1;
+    if (i < argc && std::string{argv[i]} == "--own-tables")
+    {
+        options.SharedTable = false;
+        ++i;
+    }
+
+    if (argc - i < 2)
+    {
+        return Usage(argv[0]);
+    }
+
+    const std::string command{argv[i]};
+    const std::string archive{argv[i + 1]};
+
+    try
+    {
+        std::ios_base::sync_with_stdio(false);
+
+        if (command == "create" && argc - i >= 3)
+        {
+            return Create(archive, Container::TNames(argv + i + 2, argv + argc), options);
+        }
+        if (command == "list" && argc - i == 2)
+        {
+            return List(archive);
+        }
+        if (command == "extract" && argc - i == 4)
+        {
+            return Extract(archive, argv[i + 2], argv[i + 3]);
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cout << "Fail: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return Usage(argv[0]);
+}
@@ -0,0 +1,169 @@
+#include <limits>
+#include <stdexcept>
+
+#include "Batch.hpp"
+#include "BitsWriter.hpp"
+#include "DecodeTable.hpp"
+#include "FlatTree.hpp"
+#include "Kernels.hpp"
+
+namespace Batch
+{
+    using Model::BatchHeader;
+    using Model::SymbolInfo;
+
+    static constexpr size_t BufferSize = 4096;
+
+    const Model::TSymbol* Data(const std::string& aRecord)
+    {
+        return reinterpret_cast<const Model::TSymbol*>(aRecord.data());
+    }
+
+    void Encode(const TRecords& aRecords, IStorage::Output& aOutput)
+    {
+        if (aRecords.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::runtime_error("Batch: Too many records.");
+        }
+
+        // One histogram and one table for the whole batch.
+        Huffman::THistogram histogram{};
+        for (const auto& record : aRecords)
+        {
+            Kernels::Histogram(Data(record), record.size(), histogram.data());
+        }
+
+        Huffman::FlatTreeBuilder builder;
+        auto table = Huffman::SharedTable::Make(builder.Build(histogram));
+
+        BatchHeader header;
+        header.Magic = BatchHeader::Signature;
+        header.Count = static_cast<uint32_t>(aRecords.size());
+        header.Table.Length = table.Entries.size();
+
+        aOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+        aOutput.Write(reinterpret_cast<const char*>(table.Entries.data()), table.Entries.size() * sizeof(SymbolInfo));
+
+        // Leave space for records index.
+        std::vector<BatchHeader::Record> index;
+        index.reserve(aRecords.size());
+
+        aOutput.Skip(aRecords.size() * sizeof(BatchHeader::Record));
+
+        Kernels::CodeTable codes;
+        for (const auto& entry : table.Entries)
+        {
+            codes.Put(entry.Symbol, entry.Code.Value, entry.Code.Length);
+        }
+
+        // Each record starts from byte boundary, so it can be decoded alone.
+        Helpers::BitsWriter bits(aOutput, BufferSize);
+
+        for (const auto& record : aRecords)
+        {
+            auto offset = bits.BytesWritten();
+            if (offset > std::numeric_limits<uint32_t>::max() || record.size() > std::numeric_limits<uint32_t>::max())
+            {
+                throw std::runtime_error("Batch: Batch is too large.");
+            }
+
+            index.push_back(BatchHeader::Record{static_cast<uint32_t>(offset), static_cast<uint32_t>(record.size())});
+
+            bits.Encode(Data(record), record.size(), codes);
+            bits.Align();
+        }
+
+        bits.Flush();
+
+        // Stamp records index.
+        aOutput.Reset();
+        aOutput.Skip(sizeof(header) + table.Entries.size() * sizeof(SymbolInfo));
+        aOutput.Write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(BatchHeader::Record));
+    }
+
+    Reader::Reader(const char* aData, size_t aSize)
+    {
+        auto header = reinterpret_cast<const BatchHeader*>(aData);
+        if (aSize < sizeof(BatchHeader) || header->Magic != BatchHeader::Signature)
+        {
+            throw std::runtime_error("Batch: Not a batch container.");
+        }
+
+        auto tableSize = header->Table.Length * sizeof(SymbolInfo);
+        auto indexSize = header->Count * sizeof(BatchHeader::Record);
+
+        if (header->Table.Length > 256 || aSize - sizeof(BatchHeader) < tableSize + indexSize)
+        {
+            throw std::runtime_error("Batch: Invalid header.");
+        }
+
+        const auto entries = header->Table.Entries;
+        mTable = Huffman::SharedTable::Make(std::vector<SymbolInfo>(entries, entries + header->Table.Length));
+
+        mRecords = reinterpret_cast<const BatchHeader::Record*>(aData + sizeof(BatchHeader) + tableSize);
+        mCount = header->Count;
+
+        mPayload = aData + sizeof(BatchHeader) + tableSize + indexSize;
+        mPayloadSize = aSize - sizeof(BatchHeader) - tableSize - indexSize;
+
+        for (size_t i = 0; i < mCount; ++i)
+        {
+            if (mRecords[i].Offset > mPayloadSize || (i > 0 && mRecords[i].Offset < mRecords[i - 1].Offset))
+            {
+                throw std::runtime_error("Batch: Invalid records index.");
+            }
+        }
+    }
+
+    Reader::Reader(const std::string& aData)
+      : Reader{aData.data(), aData.size()}
+    {
+    }
+
+    size_t Reader::Size() const
+    {
+        return mCount;
+    }
+
+    std::string Reader::Get(size_t aIndex) const
+    {
+        if (aIndex >= mCount)
+        {
+            throw std::out_of_range("Batch: No such record.");
+        }
+
+        const auto& record = mRecords[aIndex];
+        auto end = aIndex + 1 < mCount ? mRecords[aIndex + 1].Offset : mPayloadSize;
+
+        // Room for symbols, which decoder may store past the last one.
+        std::string result(record.Size + Helpers::DecodeTable::MaxSymbols, '\0');
+
+        struct
+        {
+            char* Reserve(size_t)
+            {
+                return Data + Size;
+            }
+
+            void Commit(size_t aCount)
+            {
+                Size += aCount;
+            }
+
+            char* Data;
+            size_t Size;
+        } sink{&result[0], 0};
+
+        Helpers::SymbolsDecoder decoder{mTable.Decoding};
+        decoder.Decode(mPayload + record.Offset, end - record.Offset, record.Size, true, sink);
+
+        result.resize(sink.Size);
+
+        if (result.size() != record.Size)
+        {
+            throw std::runtime_error("Batch: Record is truncated.");
+        }
+
+        return result;
+    }
+}
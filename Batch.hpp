@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Interfaces.hpp"
+#include "Model.hpp"
+#include "SharedTable.hpp"
+
+namespace Batch
+{
+    using TRecords = std::vector<std::string>;
+
+    // Encodes all records with one table built over all of them.
+    void Encode(const TRecords& aRecords, IStorage::Output& aOutput);
+
+    // Random access to records of an encoded batch.
+    // Container must outlive the reader.
+    class Reader
+    {
+    public:
+        Reader(const char* aData, size_t aSize);
+        Reader(const std::string& aData);
+
+        size_t Size() const;
+        std::string Get(size_t aIndex) const;
+
+    private:
+        const Model::BatchHeader::Record* mRecords{nullptr};
+        size_t mCount{0};
+
+        const char* mPayload{nullptr};
+        size_t mPayloadSize{0};
+
+        Huffman::SharedTable mTable;
+    };
+}
@@ -0,0 +1,62 @@
+#include "Batch.hpp"
+#include "Memory.hpp"
+#include "TestsBase.hpp"
+
+using Model::BatchHeader;
+
+std::string EncodeBatch(const Batch::TRecords& aRecords)
+{
+    Memory::Writer writer;
+    Batch::Encode(aRecords, writer);
+    return writer.Data();
+}
+
+TEST(Batch, ShouldDecodeEachRecord)
+{
+    Batch::TRecords records{"first record", "", "second", std::string(1000, 'x'), std::string("\x00\xFF\x7F", 3)};
+
+    auto container = EncodeBatch(records);
+    Batch::Reader reader{container};
+
+    ASSERT_EQ(records.size(), reader.Size());
+
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        EXPECT_EQ(records[i], reader.Get(i));
+    }
+}
+
+TEST(Batch, ShouldStoreTableOnce)
+{
+    Batch::TRecords records(100, "AAAABBC");
+
+    auto container = EncodeBatch(records);
+
+    auto header = reinterpret_cast<const BatchHeader*>(container.data());
+    EXPECT_EQ(100u, header->Count);
+    EXPECT_EQ(3u, header->Table.Length);
+
+    // Every record takes 10 bits.
+    EXPECT_EQ(sizeof(BatchHeader) + 3 * sizeof(BatchHeader::Table.Entries[0]) +
+                  100 * (sizeof(BatchHeader::Record) + 2),
+              container.size());
+}
+
+TEST(Batch, ShouldHandleEmptyBatch)
+{
+    auto container = EncodeBatch({});
+    Batch::Reader reader{container};
+
+    EXPECT_EQ(0u, reader.Size());
+    EXPECT_ANY_THROW(reader.Get(0));
+}
+
+TEST(Batch, ShouldRejectInvalidContainer)
+{
+    EXPECT_ANY_THROW(Batch::Reader{std::string{"garbage"}});
+
+    auto container = EncodeBatch({"one", "two"});
+    container.resize(sizeof(BatchHeader));
+
+    EXPECT_ANY_THROW(Batch::Reader{container});
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Memory.hpp"
+#include "Processor.hpp"
+
+namespace
+{
+    auto Usage(const char* aToolName)
+    {
+        std::cout << "Usage: " << aToolName << " [--block-size bytes] [--runs count] file...\n";
+        return 1;
+    }
+
+    struct Mode
+    {
+        const char* Name;
+        const Stream::Options* Blocks;
+    };
+
+    struct Result
+    {
+        size_t EncodedSize{0};
+        double EncodeSeconds{0.0};
+        double DecodeSeconds{0.0};
+    };
+
+    // The best of several runs, so that warm-up and noise don't count.
+    template <typename TRun>
+    double Measure(unsigned aRuns, TRun aRun)
+    {
+        auto best = 0.0;
+        for (unsigned i = 0; i < aRuns; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            aRun();
+            auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            best = i == 0 ? seconds : std::min(best, seconds);
+        }
+        return best;
+    }
+
+    Result Run(const std::string& aData, const Mode& aMode, unsigned aRuns)
+    {
+        Processor::Config config;
+        config.Blocks = aMode.Blocks;
+
+        Result result;
+        std::string encoded;
+
+        result.EncodeSeconds = Measure(aRuns, [&]() {
+            Memory::Reader reader{aData};
+            Memory::Writer writer;
+            Processor::Encode(reader, writer, config);
+            encoded = writer.Data();
+        });
+        result.EncodedSize = encoded.size();
+
+        result.DecodeSeconds = Measure(aRuns, [&]() {
+            Memory::Reader reader{encoded};
+            Memory::Writer writer;
+            Processor::Decode(reader, writer, config);
+
+            if (writer.Data() != aData)
+            {
+                throw std::runtime_error("Bench: Decoded data differs.");
+            }
+        });
+
+        return result;
+    }
+
+    double Throughput(size_t aSize, double aSeconds)
+    {
+        return aSeconds > 0.0 ? aSize / aSeconds / (1024 * 1024) : 0.0;
+    }
+}
+
+// Compares size and speed of coding modes on given files.
+int main(int argc, char** argv)
+{
+    Stream::Options blocks;
+    unsigned runs = 3;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg{argv[i]};
+        if (arg == "--block-size" && i + 1 < argc)
+        {
+            blocks.BlockSize = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--runs" && i + 1 < argc)
+        {
+            runs = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.empty() || runs == 0 || blocks.BlockSize == 0 || blocks.BlockSize > (1u << 30))
+    {
+        return Usage(argv[0]);
+    }
+
+    auto transformed = blocks;
+    transformed.Transform = true;
+
+    Lz::Options matches;
+    auto matched = blocks;
+    matched.Matches = &matches;
+
+    auto tabled = blocks;
+    tabled.Entropy = Stream::Coder::Ans;
+
+    auto split = blocks;
+    split.Split = true;
+
+    const Mode modes[] = {{"huffman", nullptr},
+                          {"blocks", &blocks},
+                          {"blocks+bwt", &transformed},
+                          {"blocks+lz", &matched},
+                          {"blocks+ans", &tabled},
+                          {"blocks+split", &split}};
+
+    try
+    {
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << std::left << std::setw(24) << "file" << std::setw(14) << "mode" << std::right << std::setw(12)
+                  << "size" << std::setw(12) << "encoded" << std::setw(8) << "ratio" << std::setw(12) << "enc MiB/s"
+                  << std::setw(12) << "dec MiB/s" << "\n";
+
+        for (const auto& name : files)
+        {
+            std::ifstream stream{name, std::ios::binary};
+            if (!stream)
+            {
+                throw std::runtime_error("Bench: Can't open " + name + ".");
+            }
+
+            const std::string data{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+
+            for (const auto& mode : modes)
+            {
+                auto result = Run(data, mode, runs);
+
+                std::cout << std::left << std::setw(24) << name << std::setw(14) << mode.Name << std::right
+                          << std::setw(12) << data.size() << std::setw(12) << result.EncodedSize << std::setw(7)
+                          << (data.empty() ? 0.0 : 100.0 * result.EncodedSize / data.size()) << "%"
+                          << std::setw(12) << Throughput(data.size(), result.EncodeSeconds) << std::setw(12)
+                          << Throughput(data.size(), result.DecodeSeconds) << std::endl;
+            }
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cout << "Fail: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
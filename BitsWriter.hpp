@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Interfaces.hpp"
+#include "Kernels.hpp"
+
+namespace Helpers
+{
+    // Joint codes of all pairs of symbols, so that each two symbols take one
+    // append. Pairs of codes longer than 24 bits are marked to be written
+    // one by one, codes of 12 bits at most never are.
+    class PairCodes
+    {
+    public:
+        static constexpr unsigned MaxLength = 24;
+        static constexpr uint32_t Split = 0xFF;
+
+        // Building the table takes about as long as pairs save
+        // on 64K symbols, so it pays on longer data only.
+        static constexpr size_t MinSize = 128 * 1024;
+
+        static bool Pays(size_t aSize)
+        {
+            return aSize >= MinSize;
+        }
+
+        // Pair index is the first symbol in low byte, the second in high one.
+        explicit PairCodes(const Kernels::CodeTable& aCodes)
+          : mSingles(aCodes)
+          , mPairs(256 * 256)
+        {
+            for (uint32_t second = 0; second < 256; ++second)
+            {
+                const auto value = aCodes.Values[second];
+                const auto length = aCodes.Lengths[second];
+
+                for (uint32_t first = 0; first < 256; ++first)
+                {
+                    const auto total = aCodes.Lengths[first] + length;
+                    mPairs[second << 8 | first] =
+                        total > MaxLength ? Split << 24 : total << 24 | aCodes.Values[first] << length | value;
+                }
+            }
+        }
+
+        uint32_t Pair(uint32_t aIndex) const
+        {
+            return mPairs[aIndex];
+        }
+
+        const Kernels::CodeTable& Singles() const
+        {
+            return mSingles;
+        }
+
+    private:
+        Kernels::CodeTable mSingles;
+
+        // Length in high byte, value in low three.
+        std::vector<uint32_t> mPairs;
+    };
+
+    // Packs codes of up to 32 bits, most significant bit first,
+    // through 64-bit accumulator. Full buffer goes to output.
+    class BitsWriter
+    {
+    public:
+        BitsWriter(IStorage::Output& aOutput, size_t aSize)
+          : mOutput{aOutput}
+          , mBuffer{new char[aSize]}
+          , mSize{aSize}
+        {
+        }
+
+        void Write(uint32_t aValue, unsigned aLength)
+        {
+            mBits = (mBits << aLength) | aValue;
+            mCount += aLength;
+
+            while (mCount >= 8)
+            {
+                mCount -= 8;
+                Put(static_cast<char>(mBits >> mCount));
+            }
+        }
+
+        void Encode(const uint8_t* aData, size_t aSize, const Kernels::CodeTable& aCodes)
+        {
+            static constexpr size_t Chunk = 256;
+
+            const auto& kernels = Kernels::Active();
+
+            uint32_t values[Chunk];
+            uint32_t lengths[Chunk];
+
+            for (size_t offset = 0; offset < aSize; offset += Chunk)
+            {
+                auto count = aSize - offset < Chunk ? aSize - offset : Chunk;
+                kernels.Gather(aData + offset, count, aCodes.Values, aCodes.Lengths, values, lengths);
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    Write(values[i], lengths[i]);
+                }
+            }
+        }
+
+        void Encode(const uint8_t* aData, size_t aSize, const PairCodes& aCodes)
+        {
+            const auto& singles = aCodes.Singles();
+
+            size_t i = 0;
+            for (; i + 2 <= aSize; i += 2)
+            {
+                const auto code = aCodes.Pair(aData[i] | uint32_t{aData[i + 1]} << 8);
+                if ((code >> 24) == PairCodes::Split)
+                {
+                    Write(singles.Values[aData[i]], singles.Lengths[aData[i]]);
+                    Write(singles.Values[aData[i + 1]], singles.Lengths[aData[i + 1]]);
+                    continue;
+                }
+
+                Write(code & 0xFFFFFF, code >> 24);
+            }
+
+            if (i < aSize)
+            {
+                Write(singles.Values[aData[i]], singles.Lengths[aData[i]]);
+            }
+        }
+
+        // Pads last byte with zeros.
+        void Align()
+        {
+            if (mCount)
+            {
+                Put(static_cast<char>(mBits << (8 - mCount)));
+                mCount = 0;
+            }
+        }
+
+        void Flush()
+        {
+            Align();
+
+            if (mTaken)
+            {
+                mOutput.Write(mBuffer.get(), mTaken);
+                mTaken = 0;
+            }
+        }
+
+        size_t BytesWritten() const
+        {
+            return mWritten;
+        }
+
+    private:
+        void Put(char aByte)
+        {
+            mBuffer[mTaken++] = aByte;
+            mWritten++;
+
+            if (mTaken == mSize)
+            {
+                mOutput.Write(mBuffer.get(), mTaken);
+                mTaken = 0;
+            }
+        }
+
+    private:
+        IStorage::Output& mOutput;
+
+        std::unique_ptr<char[]> mBuffer;
+        size_t mSize{0};
+        size_t mTaken{0};
+        size_t mWritten{0};
+
+        uint64_t mBits{0};
+        unsigned mCount{0};
+    };
+}
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "Budget.hpp"
+
+namespace Budget
+{
+    Tracker::Tracker(size_t aLimit)
+      : mLimit{aLimit}
+    {
+    }
+
+    bool Tracker::TryTake(size_t aSize)
+    {
+        auto used = mUsed.load();
+        do
+        {
+            if (aSize > mLimit - used)
+            {
+                return false;
+            }
+        } while (!mUsed.compare_exchange_weak(used, used + aSize));
+
+        auto peak = mPeak.load();
+        while (peak < used + aSize && !mPeak.compare_exchange_weak(peak, used + aSize))
+        {
+        }
+
+        return true;
+    }
+
+    void Tracker::Give(size_t aSize)
+    {
+        mUsed -= aSize;
+    }
+
+    size_t Tracker::Limit() const
+    {
+        return mLimit;
+    }
+
+    size_t Tracker::Used() const
+    {
+        return mUsed;
+    }
+
+    size_t Tracker::Available() const
+    {
+        return mLimit - mUsed;
+    }
+
+    size_t Tracker::Peak() const
+    {
+        return mPeak;
+    }
+
+    Lease::Lease(Tracker* aTracker, size_t aSize)
+    {
+        if (aTracker && aSize)
+        {
+            if (!aTracker->TryTake(aSize))
+            {
+                throw std::runtime_error("Budget: Memory limit is exceeded.");
+            }
+
+            mTracker = aTracker;
+            mSize = aSize;
+        }
+    }
+
+    Lease::~Lease()
+    {
+        Release();
+    }
+
+    Lease::Lease(Lease&& aOther) noexcept
+      : mTracker{aOther.mTracker}
+      , mSize{aOther.mSize}
+    {
+        aOther.mTracker = nullptr;
+        aOther.mSize = 0;
+    }
+
+    Lease& Lease::operator=(Lease&& aOther) noexcept
+    {
+        if (this != &aOther)
+        {
+            Release();
+            std::swap(mTracker, aOther.mTracker);
+            std::swap(mSize, aOther.mSize);
+        }
+        return *this;
+    }
+
+    Lease Lease::Share(Tracker* aTracker, size_t aPart, size_t& aCount)
+    {
+        Lease lease;
+        if (!aTracker)
+        {
+            return lease;
+        }
+
+        // Others may take from the same tracker meanwhile, so the count,
+        // which fits now, is tried down to the one, which is taken.
+        for (; aCount; --aCount)
+        {
+            auto count = std::min(aCount, aPart ? aTracker->Available() / aPart : aCount);
+            if (count && aTracker->TryTake(count * aPart))
+            {
+                aCount = count;
+                lease.mTracker = aTracker;
+                lease.mSize = count * aPart;
+                break;
+            }
+        }
+
+        return lease;
+    }
+
+    void Lease::Release()
+    {
+        if (mTracker)
+        {
+            mTracker->Give(mSize);
+            mTracker = nullptr;
+            mSize = 0;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace Budget
+{
+    // Counts bytes of large buffers, tables and threads of coding against
+    // a limit. It may be shared by threads of one job or of many of them.
+    class Tracker
+    {
+    public:
+        explicit Tracker(size_t aLimit);
+
+        Tracker(const Tracker&) = delete;
+        Tracker& operator=(const Tracker&) = delete;
+
+        // Takes nothing and returns false, if aSize bytes don't fit.
+        bool TryTake(size_t aSize);
+        void Give(size_t aSize);
+
+        size_t Limit() const;
+        size_t Used() const;
+        size_t Available() const;
+
+        // The most bytes, which were taken at once.
+        size_t Peak() const;
+
+    private:
+        const size_t mLimit;
+        std::atomic<size_t> mUsed{0};
+        std::atomic<size_t> mPeak{0};
+    };
+
+    // Bytes taken from tracker until lease is released or destroyed.
+    // Lease of no tracker takes nothing, so callers needn't check for one.
+    class Lease
+    {
+    public:
+        Lease() = default;
+
+        // Throws if aSize bytes don't fit.
+        Lease(Tracker* aTracker, size_t aSize);
+
+        ~Lease();
+
+        Lease(Lease&& aOther) noexcept;
+        Lease& operator=(Lease&& aOther) noexcept;
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        // Takes as many parts of aPart bytes, up to aCount, as fit and sets
+        // aCount to their number, which is zero if none of them fits.
+        static Lease Share(Tracker* aTracker, size_t aPart, size_t& aCount);
+
+        void Release();
+
+    private:
+        Tracker* mTracker{nullptr};
+        size_t mSize{0};
+    };
+}
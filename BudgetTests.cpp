@@ -0,0 +1,116 @@
+#include "Budget.hpp"
+#include "Memory.hpp"
+#include "Processor.hpp"
+#include "TestsBase.hpp"
+
+TEST(Budget, ShouldTakeOnlyWhatFits)
+{
+    Budget::Tracker tracker{100};
+
+    EXPECT_TRUE(tracker.TryTake(60));
+    EXPECT_FALSE(tracker.TryTake(50));
+    EXPECT_TRUE(tracker.TryTake(40));
+    EXPECT_EQ(0u, tracker.Available());
+
+    tracker.Give(70);
+    EXPECT_EQ(30u, tracker.Used());
+    EXPECT_EQ(100u, tracker.Peak());
+}
+
+TEST(Budget, ShouldGiveLeaseBack)
+{
+    Budget::Tracker tracker{100};
+    {
+        Budget::Lease lease{&tracker, 40};
+        EXPECT_EQ(40u, tracker.Used());
+
+        // Moved lease is given back once.
+        Budget::Lease moved{std::move(lease)};
+        lease.Release();
+        EXPECT_EQ(40u, tracker.Used());
+
+        EXPECT_THROW((Budget::Lease{&tracker, 61}), std::runtime_error);
+        EXPECT_EQ(40u, tracker.Used());
+    }
+    EXPECT_EQ(0u, tracker.Used());
+
+    // No tracker, no limit.
+    Budget::Lease lease{nullptr, 1000};
+}
+
+TEST(Budget, ShouldShareAsManyPartsAsFit)
+{
+    Budget::Tracker tracker{100};
+    Budget::Lease taken{&tracker, 10};
+
+    size_t count = 8;
+    auto lease = Budget::Lease::Share(&tracker, 30, count);
+
+    EXPECT_EQ(3u, count);
+    EXPECT_EQ(100u, tracker.Used());
+
+    count = 2;
+    Budget::Lease::Share(&tracker, 30, count);
+    EXPECT_EQ(0u, count);
+
+    count = 8;
+    Budget::Lease::Share(nullptr, 30, count);
+    EXPECT_EQ(8u, count);
+}
+
+TEST(Budget, ShouldFitSettingsInBudget)
+{
+    Stream::Options blocks;
+    blocks.BlockSize = 4 * 1024 * 1024;
+    blocks.Transform = true;
+
+    Uring::Options pipeline;
+
+    Processor::Config config;
+    config.Threads = 16;
+    config.Blocks = &blocks;
+
+    const size_t budget = 64 * 1024 * 1024;
+    ASSERT_GT(Processor::Footprint(config, &pipeline), budget);
+
+    Processor::Fit(budget, config, &blocks, &pipeline);
+
+    EXPECT_LE(Processor::Footprint(config, &pipeline), budget);
+    EXPECT_GE(config.Threads, 1u);
+    EXPECT_LT(config.Threads, 16u);
+
+    EXPECT_THROW(Processor::Fit(1024, config, &blocks, &pipeline), std::runtime_error);
+}
+
+TEST(Budget, ShouldCodeWithFewerThreadsInBudget)
+{
+    std::string source(4 * 1024 * 1024, 'A');
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        source[i] = static_cast<char>('A' + i % 7 * i % 5);
+    }
+
+    Memory::Reader input{source};
+    Memory::Writer sequential;
+    Processor::Encode(input, sequential);
+
+    // Budget has room for about half of threads.
+    Processor::Config config;
+    config.Threads = 4;
+
+    Budget::Tracker tracker{Processor::Footprint(config) / 2};
+    config.Memory = &tracker;
+
+    Memory::Writer encoded;
+    Processor::Encode(input, encoded, config);
+    EXPECT_EQ(sequential.Data().size(), encoded.Data().size());
+
+    Memory::Reader reader{encoded.Data()};
+    Memory::Writer decoded;
+    Processor::Decode(reader, decoded, config);
+    EXPECT_EQ(source, decoded.Data());
+
+    EXPECT_EQ(0u, tracker.Used());
+    EXPECT_LE(tracker.Peak(), tracker.Limit());
+    EXPECT_GT(tracker.Peak(), 0u);
+}
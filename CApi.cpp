@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include "Memory.hpp"
+#include "Processor.hpp"
+#include "Stream.hpp"
+#include "huffman.h"
+
+using Model::FileHeader;
+
+struct huffman_encoder
+{
+    // Keeps encoded data until it is read.
+    struct Queue final : IStorage::Output
+    {
+        virtual void Write(const char* aBuffer, size_t aSize) override
+        {
+            Data.append(aBuffer, aSize);
+        }
+
+        virtual void Skip(const size_t) override
+        {
+            throw std::logic_error("CApi: Stream can't skip.");
+        }
+
+        virtual void Reset() override
+        {
+            throw std::logic_error("CApi: Stream can't reset.");
+        }
+
+        std::string Data;
+        size_t Taken{0};
+    };
+
+    explicit huffman_encoder(const Stream::Options& aOptions)
+      : Encoder{Output, aOptions}
+    {
+    }
+
+    Queue Output;
+    Stream::Encoder Encoder;
+};
+
+struct huffman_decoder
+{
+    Stream::Decoder Decoder;
+};
+
+namespace
+{
+    thread_local std::string LastError;
+
+    // Writes into caller's buffer, which must be large enough.
+    struct BufferWriter final : IStorage::Output
+    {
+        BufferWriter(char* aData, size_t aCapacity)
+          : mData{aData}
+          , mCapacity{aCapacity}
+        {
+        }
+
+        virtual void Write(const char* aBuffer, size_t aSize) override
+        {
+            if (mCapacity - mPosition < aSize)
+            {
+                throw std::length_error("CApi: Buffer is too small.");
+            }
+
+            std::memcpy(mData + mPosition, aBuffer, aSize);
+            mPosition += aSize;
+            mSize = std::max(mSize, mPosition);
+        }
+
+        virtual void Skip(const size_t aSize) override
+        {
+            mPosition += aSize;
+        }
+
+        virtual void Reset() override
+        {
+            mPosition = 0;
+        }
+
+        size_t Size() const
+        {
+            return mSize;
+        }
+
+    private:
+        char* mData;
+        size_t mCapacity;
+        size_t mPosition{0};
+        size_t mSize{0};
+    };
+
+    huffman_status Fail(huffman_status aStatus, const char* aMessage)
+    {
+        LastError = aMessage;
+        return aStatus;
+    }
+
+    // Exceptions must not cross C boundary.
+    template <typename TFunction>
+    huffman_status Guard(TFunction aFunction)
+    {
+        try
+        {
+            aFunction();
+            return HUFFMAN_OK;
+        }
+        catch (const std::bad_alloc& e)
+        {
+            return Fail(HUFFMAN_ERROR_MEMORY, e.what());
+        }
+        catch (const std::length_error& e)
+        {
+            return Fail(HUFFMAN_ERROR_BUFFER_TOO_SMALL, e.what());
+        }
+        catch (const std::invalid_argument& e)
+        {
+            return Fail(HUFFMAN_ERROR_ARGUMENT, e.what());
+        }
+        catch (const std::logic_error& e)
+        {
+            return Fail(HUFFMAN_ERROR_STATE, e.what());
+        }
+        catch (const std::runtime_error& e)
+        {
+            return Fail(HUFFMAN_ERROR_DATA, e.what());
+        }
+        catch (...)
+        {
+            return Fail(HUFFMAN_ERROR_INTERNAL, "CApi: Unknown error.");
+        }
+    }
+}
+
+const char* huffman_status_string(huffman_status status)
+{
+    switch (status)
+    {
+    case HUFFMAN_OK:
+        return "Success";
+    case HUFFMAN_ERROR_ARGUMENT:
+        return "Invalid argument";
+    case HUFFMAN_ERROR_BUFFER_TOO_SMALL:
+        return "Buffer is too small";
+    case HUFFMAN_ERROR_DATA:
+        return "Invalid data";
+    case HUFFMAN_ERROR_MEMORY:
+        return "Out of memory";
+    case HUFFMAN_ERROR_STATE:
+        return "Invalid state";
+    case HUFFMAN_ERROR_INTERNAL:
+        return "Internal error";
+    }
+    return "Unknown status";
+}
+
+const char* huffman_last_error(void)
+{
+    return LastError.c_str();
+}
+
+size_t huffman_encode_bound(size_t size)
+{
+    // Huffman codes take at most one bit per symbol more than entropy.
+    return sizeof(FileHeader) + 256 * sizeof(FileHeader::SymbolsTable::Entry) + size / 8 * 9 + size % 8 + 2;
+}
+
+huffman_status huffman_encode(const void* src, size_t src_size, void* dst, size_t dst_capacity, size_t* dst_size)
+{
+    if ((!src && src_size) || (!dst && dst_capacity) || !dst_size)
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    return Guard([&]() {
+        Memory::Reader input{static_cast<const char*>(src), src_size};
+        Memory::Writer output;
+
+        Processor::Encode(input, output);
+
+        *dst_size = output.Data().size();
+        if (output.Data().size() > dst_capacity)
+        {
+            throw std::length_error("CApi: Buffer is too small.");
+        }
+
+        std::memcpy(dst, output.Data().data(), output.Data().size());
+    });
+}
+
+huffman_status huffman_decoded_size(const void* src, size_t src_size, size_t* size)
+{
+    if (!src || !size)
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    FileHeader header;
+    if (src_size < sizeof(header))
+    {
+        return Fail(HUFFMAN_ERROR_DATA, "CApi: Data has no header.");
+    }
+
+    std::memcpy(&header, src, sizeof(header));
+    *size = header.FileSize;
+    return HUFFMAN_OK;
+}
+
+huffman_status huffman_decode(const void* src, size_t src_size, void* dst, size_t dst_capacity, size_t* dst_size)
+{
+    if (!src || (!dst && dst_capacity) || !dst_size)
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    size_t size = 0;
+    auto status = huffman_decoded_size(src, src_size, &size);
+    if (status != HUFFMAN_OK)
+    {
+        return status;
+    }
+
+    *dst_size = size;
+    if (size > dst_capacity)
+    {
+        return Fail(HUFFMAN_ERROR_BUFFER_TOO_SMALL, "CApi: Buffer is too small.");
+    }
+
+    return Guard([&]() {
+        Memory::Reader input{static_cast<const char*>(src), src_size};
+        BufferWriter output{static_cast<char*>(dst), dst_capacity};
+
+        Processor::Decode(input, output);
+        *dst_size = output.Size();
+    });
+}
+
+huffman_status huffman_encoder_create(size_t block_size, huffman_encoder** encoder)
+{
+    if (!encoder)
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    return Guard([&]() {
+        Stream::Options options;
+        if (block_size)
+        {
+            options.BlockSize = block_size;
+        }
+
+        *encoder = new huffman_encoder{options};
+    });
+}
+
+huffman_status huffman_encoder_feed(huffman_encoder* encoder, const void* data, size_t size)
+{
+    if (!encoder || (!data && size))
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    return Guard([&]() { encoder->Encoder.Feed(static_cast<const char*>(data), size); });
+}
+
+huffman_status huffman_encoder_flush(huffman_encoder* encoder)
+{
+    if (!encoder)
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    return Guard([&]() { encoder->Encoder.Flush(); });
+}
+
+huffman_status huffman_encoder_finish(huffman_encoder* encoder)
+{
+    if (!encoder)
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    return Guard([&]() { encoder->Encoder.Finish(); });
+}
+
+size_t huffman_encoder_pending(const huffman_encoder* encoder)
+{
+    return encoder ? encoder->Output.Data.size() - encoder->Output.Taken : 0;
+}
+
+huffman_status huffman_encoder_read(huffman_encoder* encoder, void* dst, size_t capacity, size_t* size)
+{
+    if (!encoder || (!dst && capacity) || !size)
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    auto& queue = encoder->Output;
+
+    *size = std::min(capacity, queue.Data.size() - queue.Taken);
+    std::memcpy(dst, queue.Data.data() + queue.Taken, *size);
+    queue.Taken += *size;
+
+    // Everything is read, so memory may be reused.
+    if (queue.Taken == queue.Data.size())
+    {
+        queue.Data.clear();
+        queue.Taken = 0;
+    }
+
+    return HUFFMAN_OK;
+}
+
+void huffman_encoder_destroy(huffman_encoder* encoder)
+{
+    delete encoder;
+}
+
+huffman_status huffman_decoder_create(huffman_decoder** decoder)
+{
+    if (!decoder)
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    return Guard([&]() { *decoder = new huffman_decoder; });
+}
+
+huffman_status huffman_decoder_feed(huffman_decoder* decoder, const void* src, size_t src_size, size_t* consumed,
+                                    void* dst, size_t dst_capacity, size_t* produced)
+{
+    if (!decoder || (!src && src_size) || (!dst && dst_capacity) || !consumed || !produced)
+    {
+        return Fail(HUFFMAN_ERROR_ARGUMENT, "CApi: Invalid argument.");
+    }
+
+    *consumed = 0;
+    *produced = 0;
+
+    return Guard([&]() {
+        auto result =
+            decoder->Decoder.Feed(static_cast<const char*>(src), src_size, static_cast<char*>(dst), dst_capacity);
+
+        *consumed = result.Consumed;
+        *produced = result.Produced;
+    });
+}
+
+int huffman_decoder_finished(const huffman_decoder* decoder)
+{
+    return decoder && decoder->Decoder.Finished() ? 1 : 0;
+}
+
+void huffman_decoder_destroy(huffman_decoder* decoder)
+{
+    delete decoder;
+}
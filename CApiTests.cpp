@@ -0,0 +1,95 @@
+#include <vector>
+
+#include "TestsBase.hpp"
+#include "huffman.h"
+
+TEST(CApi, ShouldEncodeAndDecodeBuffer)
+{
+    const std::string source = "abracadabra, abracadabra, abracadabra";
+
+    std::vector<char> encoded(huffman_encode_bound(source.size()));
+    size_t encodedSize = 0;
+    ASSERT_EQ(HUFFMAN_OK, huffman_encode(source.data(), source.size(), encoded.data(), encoded.size(), &encodedSize));
+
+    size_t decodedSize = 0;
+    ASSERT_EQ(HUFFMAN_OK, huffman_decoded_size(encoded.data(), encodedSize, &decodedSize));
+    ASSERT_EQ(source.size(), decodedSize);
+
+    std::vector<char> decoded(decodedSize);
+    ASSERT_EQ(HUFFMAN_OK, huffman_decode(encoded.data(), encodedSize, decoded.data(), decoded.size(), &decodedSize));
+    EXPECT_EQ(source, std::string(decoded.data(), decodedSize));
+}
+
+TEST(CApi, ShouldReportRequiredSize)
+{
+    const std::string source(1000, 'x');
+
+    char small[8];
+    size_t size = 0;
+    EXPECT_EQ(HUFFMAN_ERROR_BUFFER_TOO_SMALL, huffman_encode(source.data(), source.size(), small, sizeof(small), &size));
+    EXPECT_LT(sizeof(small), size);
+    EXPECT_GE(huffman_encode_bound(source.size()), size);
+    EXPECT_STRNE("", huffman_last_error());
+}
+
+TEST(CApi, ShouldReportInvalidData)
+{
+    char data[4] = {1, 2, 3, 4};
+    char output[16];
+    size_t size = 0;
+
+    EXPECT_EQ(HUFFMAN_ERROR_DATA, huffman_decode(data, sizeof(data), output, sizeof(output), &size));
+    EXPECT_EQ(HUFFMAN_ERROR_ARGUMENT, huffman_decode(nullptr, 0, output, sizeof(output), &size));
+    EXPECT_STREQ("Invalid data", huffman_status_string(HUFFMAN_ERROR_DATA));
+}
+
+TEST(CApi, ShouldStreamThroughContexts)
+{
+    huffman_encoder* encoder = nullptr;
+    huffman_decoder* decoder = nullptr;
+    ASSERT_EQ(HUFFMAN_OK, huffman_encoder_create(0, &encoder));
+    ASSERT_EQ(HUFFMAN_OK, huffman_decoder_create(&decoder));
+
+    const std::string first = "first message, ";
+    const std::string second = "second message";
+
+    std::string decoded;
+    auto pass = [&]() {
+        char encoded[64];
+        size_t size = 0;
+        while (huffman_encoder_pending(encoder))
+        {
+            ASSERT_EQ(HUFFMAN_OK, huffman_encoder_read(encoder, encoded, sizeof(encoded), &size));
+
+            for (size_t offset = 0; offset < size;)
+            {
+                char output[16];
+                size_t consumed = 0;
+                size_t produced = 0;
+                ASSERT_EQ(HUFFMAN_OK, huffman_decoder_feed(decoder, encoded + offset, size - offset, &consumed,
+                                                           output, sizeof(output), &produced));
+                decoded.append(output, produced);
+                offset += consumed;
+            }
+        }
+    };
+
+    ASSERT_EQ(HUFFMAN_OK, huffman_encoder_feed(encoder, first.data(), first.size()));
+    ASSERT_EQ(HUFFMAN_OK, huffman_encoder_flush(encoder));
+    pass();
+
+    // Flushed data is decoded before the stream ends.
+    EXPECT_EQ(first, decoded);
+
+    ASSERT_EQ(HUFFMAN_OK, huffman_encoder_feed(encoder, second.data(), second.size()));
+    ASSERT_EQ(HUFFMAN_OK, huffman_encoder_finish(encoder));
+    pass();
+
+    EXPECT_EQ(first + second, decoded);
+    EXPECT_EQ(1, huffman_decoder_finished(decoder));
+
+    EXPECT_EQ(HUFFMAN_ERROR_STATE, huffman_encoder_feed(encoder, "a", 1));
+
+    huffman_encoder_destroy(encoder);
+    huffman_decoder_destroy(decoder);
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Cache.hpp"
+
+namespace Cache
+{
+    Blocks::Blocks(size_t aBudget)
+      : mBudget{aBudget}
+    {
+    }
+
+    TData Blocks::Get(const Key& aKey, const TDecode& aDecode)
+    {
+        std::unique_lock<std::mutex> lock{mMutex};
+
+        auto it = mEntries.find(aKey);
+        if (it != mEntries.end())
+        {
+            auto& entry = it->second;
+            if (entry.Ready)
+            {
+                mRecent.splice(mRecent.begin(), mRecent, entry.Position);
+                ++mStats.Hits;
+                return entry.Data.get();
+            }
+
+            ++mStats.Coalesced;
+
+            auto pending = entry.Data;
+            lock.unlock();
+
+            return pending.get();
+        }
+
+        ++mStats.Misses;
+
+        // Decoding goes without lock, others find it by its future.
+        std::promise<TData> promise;
+        mEntries[aKey].Data = promise.get_future().share();
+        lock.unlock();
+
+        TData data;
+        try
+        {
+            data = aDecode();
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+
+            lock.lock();
+            mEntries.erase(aKey);
+            throw;
+        }
+
+        promise.set_value(data);
+
+        lock.lock();
+
+        auto& entry = mEntries.at(aKey);
+        entry.Ready = true;
+        entry.Size = data->size();
+        entry.Position = mRecent.insert(mRecent.begin(), aKey);
+
+        mSize += entry.Size;
+        Evict();
+
+        return data;
+    }
+
+    void Blocks::Evict()
+    {
+        while (mSize > mBudget && !mRecent.empty())
+        {
+            auto it = mEntries.find(mRecent.back());
+
+            mSize -= it->second.Size;
+            mEntries.erase(it);
+            mRecent.pop_back();
+
+            ++mStats.Evictions;
+        }
+    }
+
+    uint64_t Blocks::NewFile()
+    {
+        return mFiles++;
+    }
+
+    Blocks::Statistics Blocks::Stats() const
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+
+        auto stats = mStats;
+        stats.Size = mSize;
+        return stats;
+    }
+
+    Reader::Reader(IStorage::Input& aInput, Blocks& aCache)
+      : mInput{aInput}
+      , mCache{aCache}
+      , mFile{aCache.NewFile()}
+      , mBlocks{Stream::Index(aInput)}
+    {
+        if (!mBlocks.empty())
+        {
+            mSize = mBlocks.back().Position + mBlocks.back().Header.Size;
+        }
+    }
+
+    uint64_t Reader::Size() const
+    {
+        return mSize;
+    }
+
+    size_t Reader::Read(uint64_t aOffset, char* aBuffer, size_t aSize)
+    {
+        if (aOffset >= mSize)
+        {
+            return 0;
+        }
+
+        aSize = static_cast<size_t>(std::min<uint64_t>(aSize, mSize - aOffset));
+
+        // Last block, which starts at or before offset.
+        auto it = std::upper_bound(mBlocks.begin(), mBlocks.end(), aOffset, [](uint64_t aValue, const Stream::Block& aBlock) {
+            return aValue < aBlock.Position;
+        });
+        auto index = static_cast<size_t>(it - mBlocks.begin()) - 1;
+
+        size_t done = 0;
+        while (done < aSize)
+        {
+            const auto& block = mBlocks[index];
+
+            auto data = mCache.Get(Blocks::Key{mFile, index}, [this, &block]() {
+                std::shared_ptr<std::vector<char>> decoded{new std::vector<char>(block.Header.Size)};
+                Stream::DecodeBlock(mInput, block, decoded->data());
+                return TData{decoded};
+            });
+
+            auto from = static_cast<size_t>(aOffset + done - block.Position);
+            auto count = std::min(aSize - done, data->size() - from);
+
+            std::memcpy(aBuffer + done, data->data() + from, count);
+
+            done += count;
+            ++index;
+        }
+
+        return done;
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Interfaces.hpp"
+#include "Stream.hpp"
+
+namespace Cache
+{
+    using TData = std::shared_ptr<const std::vector<char>>;
+
+    // Least recently used decoded blocks of any number of files, kept
+    // within memory budget. Blocks being decoded are shared as well, so
+    // concurrent readers of one block wait for a single decode.
+    class Blocks
+    {
+    public:
+        struct Key
+        {
+            uint64_t File;
+            uint64_t Block;
+
+            bool operator==(const Key& aOther) const
+            {
+                return File == aOther.File && Block == aOther.Block;
+            }
+        };
+
+        struct Statistics
+        {
+            uint64_t Hits;
+            uint64_t Misses;
+            uint64_t Coalesced;
+            uint64_t Evictions;
+            size_t Size;
+        };
+
+        using TDecode = std::function<TData()>;
+
+        explicit Blocks(size_t aBudget);
+
+        // Returns cached block or decodes it with given function. Errors
+        // of decoding go to all its waiters, and nothing is cached then.
+        TData Get(const Key& aKey, const TDecode& aDecode);
+
+        // Unique id of file for keys.
+        uint64_t NewFile();
+
+        Statistics Stats() const;
+
+    private:
+        struct Hash
+        {
+            size_t operator()(const Key& aKey) const
+            {
+                return std::hash<uint64_t>()(aKey.File * 0x9E3779B97F4A7C15ull ^ aKey.Block);
+            }
+        };
+
+        struct Entry
+        {
+            std::shared_future<TData> Data;
+            bool Ready{false};
+            size_t Size{0};
+            std::list<Key>::iterator Position;
+        };
+
+        void Evict();
+
+    private:
+        const size_t mBudget;
+
+        mutable std::mutex mMutex;
+        std::unordered_map<Key, Entry, Hash> mEntries;
+
+        // Ready blocks only, most recently used first.
+        std::list<Key> mRecent;
+        size_t mSize{0};
+
+        Statistics mStats{};
+        std::atomic<uint64_t> mFiles{0};
+    };
+
+    // Reads any range of decoded stream. Only blocks, which are
+    // not in cache, are decoded. Safe to read from many threads.
+    class Reader
+    {
+    public:
+        Reader(IStorage::Input& aInput, Blocks& aCache);
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        uint64_t Size() const;
+
+        // Reads fewer bytes than asked at the end of data only.
+        size_t Read(uint64_t aOffset, char* aBuffer, size_t aSize);
+
+    private:
+        IStorage::Input& mInput;
+        Blocks& mCache;
+        const uint64_t mFile;
+
+        std::vector<Stream::Block> mBlocks;
+        uint64_t mSize{0};
+    };
+}
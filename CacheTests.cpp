@@ -0,0 +1,140 @@
+#include <thread>
+
+#include "Cache.hpp"
+#include "Memory.hpp"
+#include "TestsBase.hpp"
+
+std::string MakeStream(const std::string& aSource, size_t aBlockSize)
+{
+    Memory::Writer writer;
+
+    Stream::Options options;
+    options.BlockSize = aBlockSize;
+
+    Stream::Encoder encoder{writer, options};
+    encoder.Feed(aSource.data(), aSource.size());
+    encoder.Finish();
+
+    return writer.Data();
+}
+
+std::string MakeText(size_t aSize)
+{
+    std::string text(aSize, '\0');
+    for (size_t i = 0; i < aSize; ++i)
+    {
+        text[i] = static_cast<char>('a' + (i * 7 + i / 13) % 19);
+    }
+    return text;
+}
+
+TEST(Cache, ShouldReadAnyRange)
+{
+    const auto source = MakeText(10000);
+    const auto encoded = MakeStream(source, 1000);
+
+    Memory::Reader input{encoded};
+    Cache::Blocks cache{1 << 20};
+    Cache::Reader reader{input, cache};
+
+    ASSERT_EQ(source.size(), reader.Size());
+
+    const std::pair<size_t, size_t> ranges[] = {{0, 10}, {995, 10}, {1000, 1000}, {2500, 4321}, {9990, 100}, {0, 10000}};
+    for (const auto& range : ranges)
+    {
+        std::string buffer(range.second, '\0');
+        auto count = reader.Read(range.first, &buffer[0], buffer.size());
+
+        EXPECT_EQ(source.substr(range.first, range.second), buffer.substr(0, count));
+    }
+
+    char byte;
+    EXPECT_EQ(0u, reader.Read(source.size(), &byte, 1));
+}
+
+TEST(Cache, ShouldServeHotBlocksFromMemory)
+{
+    const auto source = MakeText(8000);
+    const auto encoded = MakeStream(source, 1000);
+
+    Memory::Reader input{encoded};
+    Cache::Blocks cache{2000};
+    Cache::Reader reader{input, cache};
+
+    char buffer[100];
+    reader.Read(1500, buffer, sizeof(buffer));
+    reader.Read(1450, buffer, sizeof(buffer));
+
+    auto stats = cache.Stats();
+    EXPECT_EQ(1u, stats.Misses);
+    EXPECT_EQ(1u, stats.Hits);
+
+    // Budget holds two blocks, older ones are evicted.
+    for (size_t offset = 0; offset < source.size(); offset += 1000)
+    {
+        reader.Read(offset, buffer, sizeof(buffer));
+    }
+
+    stats = cache.Stats();
+    EXPECT_EQ(6u, stats.Evictions);
+    EXPECT_EQ(2000u, stats.Size);
+
+    reader.Read(0, buffer, sizeof(buffer));
+    EXPECT_EQ(9u, cache.Stats().Misses);
+}
+
+TEST(Cache, ShouldCoalesceConcurrentDecodes)
+{
+    Cache::Blocks cache{1 << 20};
+
+    std::atomic<int> decodes{0};
+    std::atomic<bool> release{false};
+
+    auto decode = [&]() {
+        ++decodes;
+        while (!release)
+        {
+            std::this_thread::yield();
+        }
+        return Cache::TData{new std::vector<char>(10, 'x')};
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&]() { EXPECT_EQ(10u, cache.Get(Cache::Blocks::Key{0, 7}, decode)->size()); });
+    }
+
+    while (cache.Stats().Misses + cache.Stats().Coalesced < 4)
+    {
+        std::this_thread::yield();
+    }
+    release = true;
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(1, decodes);
+    EXPECT_EQ(3u, cache.Stats().Coalesced);
+}
+
+TEST(Cache, ShouldNotCacheFailedDecode)
+{
+    Cache::Blocks cache{1 << 20};
+    const Cache::Blocks::Key key{0, 0};
+
+    EXPECT_THROW(cache.Get(key, []() -> Cache::TData { throw std::runtime_error("Test: Failed."); }), std::runtime_error);
+
+    auto data = cache.Get(key, []() { return Cache::TData{new std::vector<char>(1, 'y')}; });
+    EXPECT_EQ('y', data->front());
+    EXPECT_EQ(2u, cache.Stats().Misses);
+
+    // Stream which isn't finished can't be indexed.
+    auto encoded = MakeStream("abc", 16);
+    encoded.resize(encoded.size() - sizeof(Model::BlockHeader));
+
+    Memory::Reader input{encoded};
+    EXPECT_THROW(Cache::Reader(input, cache), std::runtime_error);
+}
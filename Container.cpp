@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "BitsWriter.hpp"
+#include "Container.hpp"
+#include "DecodeTable.hpp"
+#include "FlatTree.hpp"
+#include "Kernels.hpp"
+#include "StreamWriter.hpp"
+
+namespace Container
+{
+    using Model::ArchiveHeader;
+    using Model::FileHeader;
+    using Model::SymbolInfo;
+
+    static constexpr size_t BufferSize = 64 * 1024;
+
+    Kernels::CodeTable Flatten(const Huffman::SharedTable& aTable)
+    {
+        Kernels::CodeTable codes;
+        for (const auto& entry : aTable.Entries)
+        {
+            codes.Put(entry.Symbol, entry.Code.Value, entry.Code.Length);
+        }
+        return codes;
+    }
+
+    Huffman::SharedTable MakeTable(const Huffman::THistogram& aHistogram)
+    {
+        Huffman::FlatTreeBuilder builder;
+        return Huffman::SharedTable::Make(builder.Build(aHistogram));
+    }
+
+    void Count(IStorage::Input& aInput, Huffman::THistogram& aHistogram, char* aBuffer)
+    {
+        while (auto count = aInput.Read(aBuffer, BufferSize))
+        {
+            Kernels::Histogram(reinterpret_cast<const Model::TSymbol*>(aBuffer), count, aHistogram.data());
+        }
+    }
+
+    void WriteTable(const Huffman::SharedTable& aTable, IStorage::Output& aOutput)
+    {
+        aOutput.Write(reinterpret_cast<const char*>(aTable.Entries.data()), aTable.Entries.size() * sizeof(SymbolInfo));
+    }
+
+    // Encodes input from byte boundary. Returns number of symbols encoded.
+    uint64_t EncodeMember(IStorage::Input& aInput, IStorage::Output& aOutput, const Kernels::CodeTable& aCodes,
+                          char* aBuffer, uint64_t& aEncodedSize)
+    {
+        Helpers::BitsWriter bits(aOutput, BufferSize);
+
+        uint64_t size = 0;
+        while (auto count = aInput.Read(aBuffer, BufferSize))
+        {
+            bits.Encode(reinterpret_cast<const Model::TSymbol*>(aBuffer), count, aCodes);
+            size += count;
+        }
+
+        bits.Flush();
+        aEncodedSize += bits.BytesWritten();
+
+        return size;
+    }
+
+    void Create(const TNames& aNames, const TOpen& aOpen, IStorage::Output& aOutput, const Options& aOptions)
+    {
+        if (aNames.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::runtime_error("Container: Too many members.");
+        }
+
+        std::unique_ptr<char[]> buffer{new char[BufferSize]};
+
+        // Shared table needs a pass over all members first.
+        std::unique_ptr<Huffman::SharedTable> shared;
+        if (aOptions.SharedTable)
+        {
+            Huffman::THistogram histogram{};
+            for (const auto& name : aNames)
+            {
+                Count(*aOpen(name), histogram, buffer.get());
+            }
+
+            shared.reset(new Huffman::SharedTable(MakeTable(histogram)));
+        }
+
+        ArchiveHeader header{};
+        header.Magic = ArchiveHeader::Signature;
+        header.Count = static_cast<uint32_t>(aNames.size());
+        header.Table.Length = shared ? shared->Entries.size() : 0;
+
+        aOutput.Skip(sizeof(header));
+
+        uint64_t offset = sizeof(header);
+        if (shared)
+        {
+            WriteTable(*shared, aOutput);
+            offset += shared->Entries.size() * sizeof(SymbolInfo);
+        }
+
+        std::vector<ArchiveHeader::Member> index;
+        index.reserve(aNames.size());
+
+        for (const auto& name : aNames)
+        {
+            ArchiveHeader::Member member{};
+            member.Offset = offset;
+            member.NameLength = static_cast<uint32_t>(name.size());
+
+            auto input = aOpen(name);
+
+            if (shared)
+            {
+                member.Size = EncodeMember(*input, aOutput, Flatten(*shared), buffer.get(), member.EncodedSize);
+            }
+            else
+            {
+                // Own table goes in front of member data.
+                Huffman::THistogram histogram{};
+                Count(*input, histogram, buffer.get());
+                input->Reset();
+
+                auto table = MakeTable(histogram);
+
+                FileHeader::SymbolsTable own;
+                own.Length = table.Entries.size();
+
+                aOutput.Write(reinterpret_cast<const char*>(&own), sizeof(own));
+                WriteTable(table, aOutput);
+
+                member.EncodedSize = sizeof(own) + table.Entries.size() * sizeof(SymbolInfo);
+                member.Size = EncodeMember(*input, aOutput, Flatten(table), buffer.get(), member.EncodedSize);
+            }
+
+            offset += member.EncodedSize;
+            index.push_back(member);
+        }
+
+        // Index goes after all members, then header is stamped.
+        header.IndexOffset = offset;
+
+        for (size_t i = 0; i < index.size(); ++i)
+        {
+            aOutput.Write(reinterpret_cast<const char*>(&index[i]), sizeof(ArchiveHeader::Member));
+            aOutput.Write(aNames[i].data(), aNames[i].size());
+        }
+
+        aOutput.Reset();
+        aOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    // Reads exactly aSize bytes at aOffset.
+    void ReadExactly(IStorage::Input& aInput, uint64_t aOffset, char* aBuffer, size_t aSize)
+    {
+        if (aInput.ReadAt(aOffset, aBuffer, aSize) != aSize)
+        {
+            throw std::runtime_error("Container: Unexpected end of archive.");
+        }
+    }
+
+    std::vector<SymbolInfo> ReadTable(IStorage::Input& aInput, uint64_t aOffset, size_t aLength)
+    {
+        if (aLength > 256)
+        {
+            throw std::runtime_error("Container: Invalid symbols table.");
+        }
+
+        std::vector<SymbolInfo> entries(aLength);
+        ReadExactly(aInput, aOffset, reinterpret_cast<char*>(entries.data()), aLength * sizeof(SymbolInfo));
+        return entries;
+    }
+
+    Reader::Reader(IStorage::Input& aInput)
+      : mInput{aInput}
+    {
+        const uint64_t fileSize = mInput.Size();
+
+        ArchiveHeader header;
+        if (fileSize < sizeof(header) ||
+            mInput.ReadAt(0, reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+            header.Magic != ArchiveHeader::Signature)
+        {
+            throw std::runtime_error("Container: Not an archive.");
+        }
+
+        if (header.Table.Length)
+        {
+            mTable.reset(new Huffman::SharedTable(
+                Huffman::SharedTable::Make(ReadTable(mInput, sizeof(header), header.Table.Length))));
+        }
+
+        if (header.IndexOffset > fileSize)
+        {
+            throw std::runtime_error("Container: Invalid index.");
+        }
+
+        std::vector<char> index(fileSize - header.IndexOffset);
+        ReadExactly(mInput, header.IndexOffset, index.data(), index.size());
+
+        mMembers.reserve(std::min<size_t>(header.Count, index.size() / sizeof(ArchiveHeader::Member)));
+
+        size_t position = 0;
+        for (uint32_t i = 0; i < header.Count; ++i)
+        {
+            ArchiveHeader::Member member;
+            if (index.size() - position < sizeof(member))
+            {
+                throw std::runtime_error("Container: Invalid index.");
+            }
+
+            std::copy_n(index.data() + position, sizeof(member), reinterpret_cast<char*>(&member));
+            position += sizeof(member);
+
+            if (index.size() - position < member.NameLength || member.Offset > header.IndexOffset ||
+                member.EncodedSize > header.IndexOffset - member.Offset)
+            {
+                throw std::runtime_error("Container: Invalid index.");
+            }
+
+            mMembers.push_back(Member{std::string(index.data() + position, member.NameLength), member.Offset,
+                                      member.EncodedSize, member.Size});
+            position += member.NameLength;
+        }
+    }
+
+    size_t Reader::Count() const
+    {
+        return mMembers.size();
+    }
+
+    const Reader::Member& Reader::Get(size_t aIndex) const
+    {
+        return mMembers.at(aIndex);
+    }
+
+    size_t Reader::Find(const std::string& aName) const
+    {
+        auto it = std::find_if(mMembers.begin(), mMembers.end(), [&aName](const Member& aMember) {
+            return aMember.Name == aName;
+        });
+        return static_cast<size_t>(it - mMembers.begin());
+    }
+
+    void Reader::Extract(size_t aIndex, IStorage::Output& aOutput) const
+    {
+        const auto& member = mMembers.at(aIndex);
+
+        auto offset = member.Offset;
+        auto end = member.Offset + member.EncodedSize;
+
+        // Member without shared table carries its own one.
+        std::unique_ptr<Huffman::SharedTable> own;
+        if (!mTable)
+        {
+            FileHeader::SymbolsTable table;
+            if (member.EncodedSize < sizeof(table))
+            {
+                throw std::runtime_error("Container: Invalid member.");
+            }
+
+            ReadExactly(mInput, offset, reinterpret_cast<char*>(&table), sizeof(table));
+            offset += sizeof(table);
+
+            if (table.Length > 256 || end - offset < table.Length * sizeof(SymbolInfo))
+            {
+                throw std::runtime_error("Container: Invalid member.");
+            }
+
+            own.reset(new Huffman::SharedTable(Huffman::SharedTable::Make(ReadTable(mInput, offset, table.Length))));
+            offset += table.Length * sizeof(SymbolInfo);
+        }
+
+        const auto& table = mTable ? *mTable : *own;
+
+        Helpers::SymbolsDecoder decoder{table.Decoding};
+        Helpers::StreamWriter<> stream(aOutput);
+
+        std::unique_ptr<char[]> buffer{new char[BufferSize]};
+
+        uint64_t produced = 0;
+        while (produced < member.Size)
+        {
+            auto count = static_cast<size_t>(std::min<uint64_t>(BufferSize, end - offset));
+            ReadExactly(mInput, offset, buffer.get(), count);
+            offset += count;
+
+            auto result = decoder.Decode(buffer.get(), count, member.Size - produced, offset == end, stream);
+            produced += result.Produced;
+
+            if (offset == end)
+            {
+                break;
+            }
+        }
+
+        stream.Flush();
+
+        if (produced != member.Size)
+        {
+            throw std::runtime_error("Container: Member is truncated.");
+        }
+    }
+}
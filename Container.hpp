@@ -0,0 +1,57 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Interfaces.hpp"
+#include "Model.hpp"
+#include "SharedTable.hpp"
+
+namespace Container
+{
+    using TNames = std::vector<std::string>;
+    using TOpen = std::function<std::unique_ptr<IStorage::Input>(const std::string&)>;
+
+    struct Options
+    {
+        // One table built over all members, otherwise each
+        // member is encoded with its own table.
+        bool SharedTable{true};
+    };
+
+    // Encodes members one by one into a single archive. Members
+    // are opened on demand, so only one of them is open at a time.
+    void Create(const TNames& aNames, const TOpen& aOpen, IStorage::Output& aOutput, const Options& aOptions);
+
+    // Reads archive index and extracts members on demand, reading
+    // nothing but the index and the member itself.
+    class Reader
+    {
+    public:
+        struct Member
+        {
+            std::string Name;
+            uint64_t Offset;
+            uint64_t EncodedSize;
+            uint64_t Size;
+        };
+
+        explicit Reader(IStorage::Input& aInput);
+
+        size_t Count() const;
+        const Member& Get(size_t aIndex) const;
+
+        // Returns Count() if there is no such member.
+        size_t Find(const std::string& aName) const;
+
+        void Extract(size_t aIndex, IStorage::Output& aOutput) const;
+
+    private:
+        IStorage::Input& mInput;
+
+        std::vector<Member> mMembers;
+        std::unique_ptr<Huffman::SharedTable> mTable;
+    };
+}
@@ -0,0 +1,173 @@
+#include <map>
+
+#include "Container.hpp"
+#include "Memory.hpp"
+#include "TestsBase.hpp"
+
+namespace
+{
+    using TFiles = std::map<std::string, std::string>;
+
+    const TFiles Files{{"a.txt", "first member"},
+                       {"dir/b.bin", std::string("\x00\xFF\x7F\x00", 4)},
+                       {"empty", ""},
+                       {"long", std::string(10000, 'x') + std::string(5000, 'y')}};
+
+    std::string MakeArchive(const TFiles& aFiles, bool aSharedTable)
+    {
+        Container::TNames names;
+        for (const auto& p : aFiles)
+        {
+            names.push_back(p.first);
+        }
+
+        Container::Options options;
+        options.SharedTable = aSharedTable;
+
+        Memory::Writer writer;
+        Container::Create(names, [&aFiles](const std::string& aName) {
+            return std::unique_ptr<IStorage::Input>{new Memory::Reader{aFiles.at(aName)}};
+        }, writer, options);
+
+        return writer.Data();
+    }
+
+    std::string Extract(const Container::Reader& aReader, const std::string& aName)
+    {
+        Memory::Writer writer;
+        aReader.Extract(aReader.Find(aName), writer);
+        return writer.Data();
+    }
+
+    // Remembers bytes read at random positions.
+    struct TracingReader final : IStorage::Input
+    {
+        TracingReader(const std::string& aData)
+          : mReader{aData}
+          , Touched(aData.size(), false)
+        {
+        }
+
+        virtual bool ReadTo(TBuffer* aBuffer) override
+        {
+            return mReader.ReadTo(aBuffer);
+        }
+
+        virtual size_t Read(char* aBuffer, size_t aSize) override
+        {
+            return mReader.Read(aBuffer, aSize);
+        }
+
+        virtual void Reset() override
+        {
+            mReader.Reset();
+        }
+
+        virtual size_t ReadAt(size_t aOffset, char* aBuffer, size_t aSize) override
+        {
+            auto count = mReader.ReadAt(aOffset, aBuffer, aSize);
+            std::fill_n(Touched.begin() + aOffset, count, true);
+            return count;
+        }
+
+        virtual size_t Size() override
+        {
+            return mReader.Size();
+        }
+
+        Memory::Reader mReader;
+        std::vector<bool> Touched;
+    };
+}
+
+TEST(Container, ShouldExtractEachMemberWithSharedTable)
+{
+    auto archive = MakeArchive(Files, true);
+
+    Memory::Reader input{archive};
+    Container::Reader reader{input};
+
+    ASSERT_EQ(Files.size(), reader.Count());
+
+    for (const auto& p : Files)
+    {
+        EXPECT_EQ(p.second, Extract(reader, p.first));
+    }
+}
+
+TEST(Container, ShouldExtractEachMemberWithOwnTables)
+{
+    auto archive = MakeArchive(Files, false);
+
+    Memory::Reader input{archive};
+    Container::Reader reader{input};
+
+    ASSERT_EQ(Files.size(), reader.Count());
+
+    for (const auto& p : Files)
+    {
+        EXPECT_EQ(p.second, Extract(reader, p.first));
+    }
+}
+
+TEST(Container, ShouldListMembersInOrder)
+{
+    auto archive = MakeArchive(Files, true);
+
+    Memory::Reader input{archive};
+    Container::Reader reader{input};
+
+    size_t i = 0;
+    for (const auto& p : Files)
+    {
+        EXPECT_EQ(p.first, reader.Get(i).Name);
+        EXPECT_EQ(p.second.size(), reader.Get(i).Size);
+        ++i;
+    }
+
+    EXPECT_EQ(reader.Count(), reader.Find("missing"));
+}
+
+TEST(Container, ShouldReadOnlyExtractedMember)
+{
+    auto archive = MakeArchive(Files, false);
+
+    TracingReader input{archive};
+    Container::Reader reader{input};
+
+    auto index = reader.Find("a.txt");
+    ASSERT_LT(index, reader.Count());
+
+    Memory::Writer writer;
+    reader.Extract(index, writer);
+    EXPECT_EQ(Files.at("a.txt"), writer.Data());
+
+    // Data of other members is left untouched.
+    const auto& other = reader.Get(reader.Find("long"));
+    for (auto i = other.Offset; i < other.Offset + other.EncodedSize; ++i)
+    {
+        ASSERT_FALSE(input.Touched[i]);
+    }
+}
+
+TEST(Container, ShouldThrowIfNotAnArchive)
+{
+    auto archive = MakeArchive(Files, true);
+    archive[0] = 'X';
+
+    Memory::Reader input{archive};
+    EXPECT_THROW(Container::Reader{input}, std::runtime_error);
+
+    std::string nothing;
+    Memory::Reader empty{nothing};
+    EXPECT_THROW(Container::Reader{empty}, std::runtime_error);
+}
+
+TEST(Container, ShouldThrowIfIndexIsTruncated)
+{
+    auto archive = MakeArchive(Files, true);
+    archive.resize(archive.size() - 3);
+
+    Memory::Reader input{archive};
+    EXPECT_THROW(Container::Reader{input}, std::runtime_error);
+}
@@ -0,0 +1,237 @@
+#include <cstring>
+#include <iomanip>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Counters.hpp"
+
+namespace Counters
+{
+    double Now()
+    {
+        using namespace std::chrono;
+        return duration<double>(steady_clock::now().time_since_epoch()).count();
+    }
+
+#ifdef __linux__
+    int Open(Event aEvent)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        // Threads started later are counted too.
+        attributes.inherit = 1;
+
+        // Counters may be multiplexed, then value is scaled by running time.
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const auto cache = [](uint64_t aCache) {
+            return aCache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+
+        switch (aEvent)
+        {
+        case Cycles:
+            attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case Instructions:
+            attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case BranchMisses:
+            attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case L1Misses:
+            attributes.type = PERF_TYPE_HW_CACHE;
+            attributes.config = cache(PERF_COUNT_HW_CACHE_L1D);
+            break;
+        case LlcMisses:
+            attributes.type = PERF_TYPE_HW_CACHE;
+            attributes.config = cache(PERF_COUNT_HW_CACHE_LL);
+            break;
+        default:
+            return -1;
+        }
+
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+
+    uint64_t ReadCounter(int aDescriptor)
+    {
+        uint64_t values[3] = {};
+        if (::read(aDescriptor, values, sizeof(values)) != sizeof(values) || values[2] == 0)
+        {
+            return 0;
+        }
+
+        return values[2] == values[1] ? values[0]
+                                      : static_cast<uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+    }
+#endif
+
+    Profile::Profile()
+    {
+        mDescriptors.fill(-1);
+
+#ifdef __linux__
+        for (int event = 0; event < EventsCount; ++event)
+        {
+            mDescriptors[event] = Open(static_cast<Event>(event));
+        }
+#endif
+    }
+
+    Profile::~Profile()
+    {
+#ifdef __linux__
+        for (auto descriptor : mDescriptors)
+        {
+            if (descriptor >= 0)
+            {
+                ::close(descriptor);
+            }
+        }
+#endif
+    }
+
+    bool Profile::Available(Event aEvent) const
+    {
+        return mDescriptors[aEvent] >= 0;
+    }
+
+    Values Profile::Read() const
+    {
+        Values values;
+        values.Seconds = Now();
+
+#ifdef __linux__
+        for (int event = 0; event < EventsCount; ++event)
+        {
+            if (mDescriptors[event] >= 0)
+            {
+                values.Counts[event] = ReadCounter(mDescriptors[event]);
+            }
+        }
+#endif
+
+        return values;
+    }
+
+    void Profile::Add(const std::string& aStage, const Values& aValues)
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+
+        auto it = mStages.begin();
+        while (it != mStages.end() && it->Name != aStage)
+        {
+            ++it;
+        }
+
+        if (it == mStages.end())
+        {
+            mStages.push_back(Stage{aStage, aValues});
+            return;
+        }
+
+        for (int event = 0; event < EventsCount; ++event)
+        {
+            it->Total.Counts[event] += aValues.Counts[event];
+        }
+        it->Total.Seconds += aValues.Seconds;
+        it->Total.Bytes += aValues.Bytes;
+    }
+
+    std::vector<Profile::Stage> Profile::Stages() const
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+        return mStages;
+    }
+
+    void Profile::Report(std::ostream& aStream) const
+    {
+        const auto flags = aStream.flags();
+
+        auto column = [&aStream](bool aValid, double aValue, int aPrecision) {
+            aStream << std::setw(14);
+            if (aValid)
+            {
+                aStream << std::fixed << std::setprecision(aPrecision) << aValue;
+            }
+            else
+            {
+                aStream << "-";
+            }
+        };
+
+        aStream << std::left << std::setw(12) << "stage" << std::right << std::setw(14) << "seconds"
+                << std::setw(14) << "bytes" << std::setw(14) << "IPC" << std::setw(14) << "cycles/byte"
+                << std::setw(14) << "branch-miss" << std::setw(14) << "L1-miss" << std::setw(14) << "LLC-miss"
+                << "\n";
+
+        const auto cycles = Available(Cycles);
+        const auto instructions = Available(Instructions);
+
+        for (const auto& stage : Stages())
+        {
+            const auto& counts = stage.Total.Counts;
+
+            aStream << std::left << std::setw(12) << stage.Name << std::right;
+            column(true, stage.Total.Seconds, 6);
+            column(true, static_cast<double>(stage.Total.Bytes), 0);
+            column(cycles && instructions && counts[Cycles], static_cast<double>(counts[Instructions]) / counts[Cycles], 2);
+            column(cycles && stage.Total.Bytes, static_cast<double>(counts[Cycles]) / stage.Total.Bytes, 2);
+            column(Available(BranchMisses), static_cast<double>(counts[BranchMisses]), 0);
+            column(Available(L1Misses), static_cast<double>(counts[L1Misses]), 0);
+            column(Available(LlcMisses), static_cast<double>(counts[LlcMisses]), 0);
+            aStream << "\n";
+        }
+
+        if (!cycles)
+        {
+            aStream << "Hardware counters are not available, only time is measured.\n";
+        }
+
+        aStream.flags(flags);
+    }
+
+    Scope::Scope(Profile* aProfile, const char* aStage)
+      : mProfile{aProfile}
+      , mStage{aStage}
+    {
+        if (mProfile)
+        {
+            mStart = mProfile->Read();
+        }
+    }
+
+    Scope::~Scope()
+    {
+        if (!mProfile)
+        {
+            return;
+        }
+
+        auto values = mProfile->Read();
+        for (int event = 0; event < EventsCount; ++event)
+        {
+            values.Counts[event] -= mStart.Counts[event];
+        }
+        values.Seconds -= mStart.Seconds;
+        values.Bytes = mBytes;
+
+        mProfile->Add(mStage, values);
+    }
+
+    void Scope::Bytes(uint64_t aBytes)
+    {
+        mBytes = aBytes;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Counters
+{
+    enum Event
+    {
+        Cycles,
+        Instructions,
+        BranchMisses,
+        L1Misses,
+        LlcMisses,
+        EventsCount
+    };
+
+    struct Values
+    {
+        std::array<uint64_t, EventsCount> Counts{};
+        double Seconds{0.0};
+        uint64_t Bytes{0};
+    };
+
+    // Hardware counters of the process, through perf_event_open on Linux.
+    // Counters which kernel or hardware doesn't provide stay unavailable,
+    // then only time is measured.
+    class Profile
+    {
+    public:
+        struct Stage
+        {
+            std::string Name;
+            Values Total;
+        };
+
+        Profile();
+        ~Profile();
+
+        Profile(const Profile&) = delete;
+        Profile& operator=(const Profile&) = delete;
+
+        bool Available(Event aEvent) const;
+
+        // Counts so far, including threads which have finished.
+        Values Read() const;
+
+        // Stages with the same name are summed up.
+        void Add(const std::string& aStage, const Values& aValues);
+
+        std::vector<Stage> Stages() const;
+
+        // Table of time, IPC, cycles per byte and misses per stage.
+        void Report(std::ostream& aStream) const;
+
+    private:
+        std::array<int, EventsCount> mDescriptors;
+
+        mutable std::mutex mMutex;
+        std::vector<Stage> mStages;
+    };
+
+    // Counts a stage from construction till destruction.
+    // Does nothing without profile.
+    class Scope
+    {
+    public:
+        Scope(Profile* aProfile, const char* aStage);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        // Number of bytes processed by stage, for cycles per byte.
+        void Bytes(uint64_t aBytes);
+
+    private:
+        Profile* mProfile;
+        const char* mStage;
+
+        Values mStart;
+        uint64_t mBytes{0};
+    };
+}
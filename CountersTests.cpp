@@ -0,0 +1,91 @@
+#include <sstream>
+
+#include "Counters.hpp"
+#include "Memory.hpp"
+#include "Processor.hpp"
+#include "TestsBase.hpp"
+
+TEST(Counters, ShouldDoNothingWithoutProfile)
+{
+    Counters::Scope scope{nullptr, "stage"};
+    scope.Bytes(10);
+}
+
+TEST(Counters, ShouldSumStagesWithSameName)
+{
+    Counters::Profile profile;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        Counters::Scope scope{&profile, "first"};
+        scope.Bytes(10);
+    }
+
+    {
+        Counters::Scope scope{&profile, "second"};
+    }
+
+    auto stages = profile.Stages();
+    ASSERT_EQ(2u, stages.size());
+
+    EXPECT_EQ("first", stages[0].Name);
+    EXPECT_EQ(30u, stages[0].Total.Bytes);
+    EXPECT_LE(0.0, stages[0].Total.Seconds);
+
+    EXPECT_EQ("second", stages[1].Name);
+    EXPECT_EQ(0u, stages[1].Total.Bytes);
+}
+
+TEST(Counters, ShouldReportEachStage)
+{
+    Counters::Profile profile;
+    {
+        Counters::Scope scope{&profile, "encode"};
+        scope.Bytes(100);
+    }
+
+    std::ostringstream report;
+    profile.Report(report);
+
+    EXPECT_NE(std::string::npos, report.str().find("encode"));
+
+    // Without hardware counters report falls back to time only.
+    if (!profile.Available(Counters::Cycles))
+    {
+        EXPECT_NE(std::string::npos, report.str().find("not available"));
+    }
+}
+
+TEST(Counters, ShouldProfileProcessorStages)
+{
+    std::string source(10000, 'a');
+    source += std::string(5000, 'b');
+
+    Counters::Profile profile;
+
+    Processor::Config config;
+    config.Profile = &profile;
+
+    Memory::Reader input{source};
+    Memory::Writer output;
+    Processor::Encode(input, output, config);
+
+    std::string encoded = output.Data();
+    Memory::Reader encodedInput{encoded};
+    Memory::Writer decoded;
+    Processor::Decode(encodedInput, decoded, config);
+
+    EXPECT_EQ(source, decoded.Data());
+
+    std::vector<std::string> names;
+    for (const auto& stage : profile.Stages())
+    {
+        names.push_back(stage.Name);
+        if (stage.Name == "histogram" || stage.Name == "encode" || stage.Name == "decode")
+        {
+            EXPECT_EQ(source.size(), stage.Total.Bytes);
+        }
+    }
+
+    EXPECT_EQ((std::vector<std::string>{"histogram", "tree", "encode", "table", "decode"}), names);
+}
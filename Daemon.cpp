@@ -0,0 +1,625 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "Daemon.hpp"
+#include "Filesystem.hpp"
+#include "Memory.hpp"
+
+namespace Daemon
+{
+    Latency::Latency(size_t aCapacity)
+      : mSamples(aCapacity)
+    {
+        if (!aCapacity)
+        {
+            throw std::invalid_argument("Daemon: Invalid latency capacity.");
+        }
+    }
+
+    void Latency::Add(double aSeconds)
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+
+        mSamples[mNext] = aSeconds;
+        mNext = (mNext + 1) % mSamples.size();
+        ++mCount;
+    }
+
+    uint64_t Latency::Count() const
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+        return mCount;
+    }
+
+    std::vector<double> Latency::Samples() const
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+
+        auto count = static_cast<size_t>(std::min<uint64_t>(mCount, mSamples.size()));
+        std::vector<double> samples(mSamples.begin(), mSamples.begin() + count);
+        std::sort(samples.begin(), samples.end());
+        return samples;
+    }
+
+    namespace
+    {
+        double Percentile(const std::vector<double>& aSorted, double aFraction)
+        {
+            if (aSorted.empty())
+            {
+                return 0.0;
+            }
+
+            auto rank = static_cast<size_t>(std::ceil(std::min(std::max(aFraction, 0.0), 1.0) * aSorted.size()));
+            return aSorted[rank ? rank - 1 : 0];
+        }
+    }
+
+    double Latency::Percentile(double aFraction) const
+    {
+        return Daemon::Percentile(Samples(), aFraction);
+    }
+
+    std::string Latency::Report() const
+    {
+        auto samples = Samples();
+
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(3) << "requests " << Count();
+
+        const std::pair<const char*, double> points[] = {{"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"max", 1.0}};
+        for (const auto& point : points)
+        {
+            report << ", " << point.first << " " << Daemon::Percentile(samples, point.second) * 1000 << " ms";
+        }
+
+        return report.str();
+    }
+
+#ifndef _WIN32
+
+    namespace
+    {
+        std::runtime_error Error(const std::string& aWhat, int aError)
+        {
+            return std::runtime_error("Daemon: " + aWhat + ": " + std::strerror(aError));
+        }
+
+        sockaddr_un Address(const std::string& aPath)
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+
+            if (aPath.empty() || aPath.size() >= sizeof(address.sun_path))
+            {
+                throw std::invalid_argument("Daemon: Invalid socket path.");
+            }
+
+            std::memcpy(address.sun_path, aPath.data(), aPath.size());
+            return address;
+        }
+
+        // Returns -1 and sets errno if nobody listens on socket.
+        int TryConnect(const std::string& aPath)
+        {
+            auto address = Address(aPath);
+
+            int descriptor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (descriptor < 0)
+            {
+                throw Error("Can't create socket", errno);
+            }
+
+            if (::connect(descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                auto error = errno;
+                ::close(descriptor);
+                errno = error;
+                return -1;
+            }
+
+            return descriptor;
+        }
+
+        int Connect(const std::string& aPath)
+        {
+            auto descriptor = TryConnect(aPath);
+            if (descriptor < 0)
+            {
+                throw Error("Can't connect to " + aPath, errno);
+            }
+            return descriptor;
+        }
+
+#ifdef MSG_NOSIGNAL
+        constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+        constexpr int SendFlags = 0;
+#endif
+
+        void Send(int aSocket, const char* aBuffer, size_t aSize)
+        {
+            while (aSize)
+            {
+                auto count = ::send(aSocket, aBuffer, aSize, SendFlags);
+                if (count < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw Error("Send failed", errno);
+                }
+
+                aBuffer += count;
+                aSize -= static_cast<size_t>(count);
+            }
+        }
+
+        // Returns false if connection was closed.
+        bool Receive(int aSocket, char* aBuffer, size_t aSize)
+        {
+            while (aSize)
+            {
+                auto count = ::recv(aSocket, aBuffer, aSize, 0);
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (count <= 0)
+                {
+                    return false;
+                }
+
+                aBuffer += count;
+                aSize -= static_cast<size_t>(count);
+            }
+            return true;
+        }
+
+        void Close(int& aDescriptor)
+        {
+            if (aDescriptor >= 0)
+            {
+                ::close(aDescriptor);
+                aDescriptor = -1;
+            }
+        }
+    }
+
+    // Buffers survive requests, so warm workers don't allocate.
+    struct Server::Worker
+    {
+        std::string Input;
+        std::string Output;
+        Memory::Writer Result;
+    };
+
+    Server::Server(const std::string& aPath, const Processor::Config& aConfig, const Options& aOptions)
+      : mPath{aPath}
+      , mConfig(aConfig)
+      , mOptions(aOptions)
+    {
+        if (!mOptions.Threads)
+        {
+            throw std::invalid_argument("Daemon: Invalid number of threads.");
+        }
+
+        auto address = Address(mPath);
+
+        // Socket left by server which is gone is replaced,
+        // but not the one some server still listens on.
+        struct stat info;
+        if (::stat(mPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        {
+            auto existing = TryConnect(mPath);
+            if (existing >= 0)
+            {
+                ::close(existing);
+                throw std::runtime_error("Daemon: Socket " + mPath + " is in use.");
+            }
+            ::unlink(mPath.c_str());
+        }
+
+        mSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (mSocket < 0)
+        {
+            throw Error("Can't create socket", errno);
+        }
+
+        if (::bind(mSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(mSocket, SOMAXCONN) != 0 || ::pipe(mWake) != 0)
+        {
+            auto error = errno;
+            Close(mSocket);
+            throw Error("Can't listen on " + mPath, error);
+        }
+
+        // Workers wait for connections together,
+        // so ones that lose the race must not block.
+        ::fcntl(mSocket, F_SETFL, ::fcntl(mSocket, F_GETFL) | O_NONBLOCK);
+    }
+
+    Server::~Server()
+    {
+        Close(mSocket);
+        Close(mWake[0]);
+        Close(mWake[1]);
+        ::unlink(mPath.c_str());
+    }
+
+    void Server::Run()
+    {
+        std::vector<Worker> workers(mOptions.Threads);
+        std::vector<std::thread> threads;
+
+        for (auto& worker : workers)
+        {
+            worker.Input.reserve(mOptions.BufferSize);
+            worker.Result.Reserve(mOptions.BufferSize);
+        }
+
+        for (size_t i = 1; i < workers.size(); ++i)
+        {
+            threads.emplace_back([this, &workers, i]() { Serve(workers[i]); });
+        }
+
+        Serve(workers[0]);
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    void Server::Stop()
+    {
+        mStopping = true;
+
+        // Pipe is never read, so it wakes all workers at once.
+        char byte = 0;
+        auto written = ::write(mWake[1], &byte, 1);
+        (void)written;
+    }
+
+    const Latency& Server::Latencies() const
+    {
+        return mLatency;
+    }
+
+    void Server::Serve(Worker& aWorker)
+    {
+        while (!mStopping)
+        {
+            pollfd descriptors[2] = {{mSocket, POLLIN, 0}, {mWake[0], POLLIN, 0}};
+            if (::poll(descriptors, 2, -1) < 0 || !(descriptors[0].revents & POLLIN))
+            {
+                continue;
+            }
+
+            int connection = ::accept(mSocket, nullptr, nullptr);
+            if (connection < 0)
+            {
+                continue;
+            }
+
+            ::fcntl(connection, F_SETFL, ::fcntl(connection, F_GETFL) & ~O_NONBLOCK);
+
+            try
+            {
+                while (Handle(aWorker, connection))
+                {
+                }
+            }
+            catch (const std::exception&)
+            {
+                // Client is gone, nothing to report to.
+            }
+
+            ::close(connection);
+        }
+    }
+
+    // Waits for each part of data, so that clients, which send nothing,
+    // are dropped after timeout, and stopping server doesn't hang on them.
+    bool Server::Receive(int aSocket, char* aBuffer, size_t aSize)
+    {
+        while (aSize)
+        {
+            pollfd descriptors[2] = {{aSocket, POLLIN, 0}, {mWake[0], POLLIN, 0}};
+            auto ready = ::poll(descriptors, 2, static_cast<int>(mOptions.TimeoutMs));
+            if (ready < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (ready <= 0 || mStopping || !descriptors[0].revents)
+            {
+                return false;
+            }
+
+            auto count = ::recv(aSocket, aBuffer, aSize, 0);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return false;
+            }
+
+            aBuffer += count;
+            aSize -= static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    // Waits for room the same way, so that clients, which don't read
+    // their responses, don't hold workers either.
+    bool Server::Send(int aSocket, const char* aBuffer, size_t aSize)
+    {
+        while (aSize)
+        {
+            pollfd descriptors[2] = {{aSocket, POLLOUT, 0}, {mWake[0], POLLIN, 0}};
+            auto ready = ::poll(descriptors, 2, static_cast<int>(mOptions.TimeoutMs));
+            if (ready < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (ready <= 0 || mStopping || !descriptors[0].revents)
+            {
+                return false;
+            }
+
+            auto count = ::send(aSocket, aBuffer, aSize, SendFlags | MSG_DONTWAIT);
+            if (count < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return false;
+            }
+
+            aBuffer += count;
+            aSize -= static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    bool Server::Respond(int aSocket, uint32_t aStatus, const std::string& aPayload)
+    {
+        Response response{};
+        response.Status = aStatus;
+        response.Length = aPayload.size();
+
+        return Send(aSocket, reinterpret_cast<const char*>(&response), sizeof(response)) &&
+               Send(aSocket, aPayload.data(), aPayload.size());
+    }
+
+    // Returns false when connection is done.
+    bool Server::Handle(Worker& aWorker, int aSocket)
+    {
+        Request request;
+        if (!Receive(aSocket, reinterpret_cast<char*>(&request), sizeof(request)))
+        {
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (request.Magic != Request::Signature || request.InputLength > mOptions.MaxData ||
+            request.OutputLength > mOptions.MaxData)
+        {
+            Respond(aSocket, Response::Failed, "Daemon: Invalid request.");
+            return false;
+        }
+
+        // Lease lasts for the request, as its coding takes from the same budget.
+        Budget::Lease lease;
+        try
+        {
+            lease = Budget::Lease{mConfig.Memory, static_cast<size_t>(request.InputLength + request.OutputLength)};
+        }
+        catch (const std::exception& e)
+        {
+            Respond(aSocket, Response::Failed, e.what());
+            return false;
+        }
+
+        aWorker.Input.resize(static_cast<size_t>(request.InputLength));
+        aWorker.Output.resize(static_cast<size_t>(request.OutputLength));
+
+        if (!Receive(aSocket, &aWorker.Input[0], aWorker.Input.size()) ||
+            !Receive(aSocket, &aWorker.Output[0], aWorker.Output.size()))
+        {
+            return false;
+        }
+
+        if (request.Kind == Operation::Stats)
+        {
+            return Respond(aSocket, Response::Ok, mLatency.Report());
+        }
+
+        aWorker.Result.Clear();
+
+        std::string error;
+        try
+        {
+            if (request.Kind != Operation::Encode && request.Kind != Operation::Decode)
+            {
+                throw std::runtime_error("Daemon: Unknown operation.");
+            }
+
+            void (*routine)(IStorage::Input&, IStorage::Output&, const Processor::Config&) = Processor::Decode;
+            if (request.Kind == Operation::Encode)
+            {
+                routine = Processor::Encode;
+            }
+
+            if (request.InBand)
+            {
+                Memory::Reader reader{aWorker.Input};
+                routine(reader, aWorker.Result, mConfig);
+            }
+            else
+            {
+                if (!std::ifstream{aWorker.Input})
+                {
+                    throw std::runtime_error("Daemon: Can't open " + aWorker.Input + ".");
+                }
+
+                Filesystem::Reader reader{aWorker.Input};
+                Filesystem::Writer writer{aWorker.Output};
+                routine(reader, writer, mConfig);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+        }
+
+        // Counted before response goes out, so client sees its own request in stats.
+        mLatency.Add(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        if (error.empty())
+        {
+            const auto& data = aWorker.Result.Data();
+
+            Response response{};
+            response.Status = Response::Ok;
+            response.Length = data.size();
+
+            return Send(aSocket, reinterpret_cast<const char*>(&response), sizeof(response)) &&
+                   Send(aSocket, data.data(), data.size());
+        }
+
+        return Respond(aSocket, Response::Failed, error);
+    }
+
+    Client::Client(const std::string& aPath)
+      : mSocket{Connect(aPath)}
+    {
+    }
+
+    Client::~Client()
+    {
+        Close(mSocket);
+    }
+
+    void Client::Process(Operation aOperation, const std::string& aInput, const std::string& aOutput)
+    {
+        Call(aOperation, false, aInput, aOutput);
+    }
+
+    std::string Client::Process(Operation aOperation, const std::string& aData)
+    {
+        return Call(aOperation, true, aData, {});
+    }
+
+    std::string Client::Stats()
+    {
+        return Call(Operation::Stats, false, {}, {});
+    }
+
+    std::string Client::Call(Operation aOperation, bool aInBand, const std::string& aInput, const std::string& aOutput)
+    {
+        Request request{};
+        request.Magic = Request::Signature;
+        request.Kind = aOperation;
+        request.InBand = aInBand;
+        request.InputLength = aInput.size();
+        request.OutputLength = aOutput.size();
+
+        Send(mSocket, reinterpret_cast<const char*>(&request), sizeof(request));
+        Send(mSocket, aInput.data(), aInput.size());
+        Send(mSocket, aOutput.data(), aOutput.size());
+
+        Response response;
+        if (!Daemon::Receive(mSocket, reinterpret_cast<char*>(&response), sizeof(response)))
+        {
+            throw std::runtime_error("Daemon: Connection closed.");
+        }
+
+        std::string payload(static_cast<size_t>(response.Length), '\0');
+        if (!Daemon::Receive(mSocket, &payload[0], payload.size()))
+        {
+            throw std::runtime_error("Daemon: Connection closed.");
+        }
+
+        if (response.Status != Response::Ok)
+        {
+            throw std::runtime_error(payload);
+        }
+
+        return payload;
+    }
+
+#else
+
+    struct Server::Worker
+    {
+    };
+
+    Server::Server(const std::string& aPath, const Processor::Config& aConfig, const Options& aOptions)
+      : mPath{aPath}
+      , mConfig(aConfig)
+      , mOptions(aOptions)
+    {
+        throw std::runtime_error("Daemon: Not supported on this platform.");
+    }
+
+    Server::~Server() = default;
+
+    void Server::Run()
+    {
+    }
+
+    void Server::Stop()
+    {
+    }
+
+    const Latency& Server::Latencies() const
+    {
+        return mLatency;
+    }
+
+    Client::Client(const std::string&)
+    {
+        throw std::runtime_error("Daemon: Not supported on this platform.");
+    }
+
+    Client::~Client() = default;
+
+    void Client::Process(Operation, const std::string&, const std::string&)
+    {
+    }
+
+    std::string Client::Process(Operation, const std::string&)
+    {
+        return {};
+    }
+
+    std::string Client::Stats()
+    {
+        return {};
+    }
+
+#endif
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Processor.hpp"
+
+namespace Daemon
+{
+    enum class Operation : uint8_t
+    {
+        Encode = 0,
+        Decode = 1,
+        Stats = 2
+    };
+
+    // Request is followed by input, either path or data itself, and
+    // by output path. In-band requests have no output path, their
+    // result comes back with response.
+    struct Request
+    {
+        static constexpr uint32_t Signature = 0x51524448; // "HDRQ"
+
+        uint32_t Magic;
+        Operation Kind;
+        uint8_t InBand;
+        uint16_t Reserved;
+        uint64_t InputLength;
+        uint64_t OutputLength;
+    };
+
+    // Response is followed by result data, latency report,
+    // or error message if request failed.
+    struct Response
+    {
+        enum : uint32_t
+        {
+            Ok = 0,
+            Failed = 1
+        };
+
+        uint32_t Status;
+        uint32_t Reserved;
+        uint64_t Length;
+    };
+
+    // Latencies of the most recent requests.
+    class Latency
+    {
+    public:
+        explicit Latency(size_t aCapacity = 64 * 1024);
+
+        void Add(double aSeconds);
+        uint64_t Count() const;
+
+        // Given fraction of recent requests took no longer than returned
+        // number of seconds. Zero if there were no requests.
+        double Percentile(double aFraction) const;
+
+        // One line of count and percentiles in milliseconds.
+        std::string Report() const;
+
+    private:
+        std::vector<double> Samples() const;
+
+    private:
+        mutable std::mutex mMutex;
+        std::vector<double> mSamples;
+        size_t mNext{0};
+        uint64_t mCount{0};
+    };
+
+    struct Options
+    {
+        // Requests are served by a fixed set of workers, each
+        // keeps buffers of given size between requests.
+        unsigned Threads{4};
+        size_t BufferSize{1024 * 1024};
+
+        // Larger in-band data is refused.
+        uint64_t MaxData{256 * 1024 * 1024};
+
+        // Connection, which sends or takes nothing for this long, is closed,
+        // so that idle and stalled clients don't hold workers.
+        unsigned TimeoutMs{30000};
+    };
+
+    // Serves encode and decode requests on Unix domain socket. Shared
+    // tables of configuration are loaded once and used by all requests.
+    class Server
+    {
+    public:
+        Server(const std::string& aPath, const Processor::Config& aConfig, const Options& aOptions = {});
+        ~Server();
+
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+        // Blocks until Stop() is called.
+        void Run();
+
+        // Safe to call from signal handler.
+        void Stop();
+
+        const Latency& Latencies() const;
+
+    private:
+        struct Worker;
+
+        void Serve(Worker& aWorker);
+        bool Handle(Worker& aWorker, int aSocket);
+        bool Receive(int aSocket, char* aBuffer, size_t aSize);
+        bool Send(int aSocket, const char* aBuffer, size_t aSize);
+        bool Respond(int aSocket, uint32_t aStatus, const std::string& aPayload);
+
+    private:
+        std::string mPath;
+        Processor::Config mConfig;
+        Options mOptions;
+
+        int mSocket{-1};
+        int mWake[2]{-1, -1};
+        std::atomic<bool> mStopping{false};
+
+        Latency mLatency;
+    };
+
+    // One connection to server, requests go one after another.
+    class Client
+    {
+    public:
+        explicit Client(const std::string& aPath);
+        ~Client();
+
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        // Paths are opened by server, so relative ones are
+        // taken from its current directory.
+        void Process(Operation aOperation, const std::string& aInput, const std::string& aOutput);
+        std::string Process(Operation aOperation, const std::string& aData);
+
+        std::string Stats();
+
+    private:
+        std::string Call(Operation aOperation, bool aInBand, const std::string& aInput, const std::string& aOutput);
+
+    private:
+        int mSocket{-1};
+    };
+}
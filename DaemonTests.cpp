@@ -0,0 +1,226 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Daemon.hpp"
+#include "TestsBase.hpp"
+
+using Daemon::Operation;
+
+// Server running on its own thread for the time of a test.
+struct RunningServer
+{
+    explicit RunningServer(const Processor::Config& aConfig = {})
+      : Path{std::string{"/tmp/huffman-daemon-"} + std::to_string(reinterpret_cast<uintptr_t>(this))}
+      , Server{Path, aConfig, MakeOptions()}
+      , Thread{[this]() { Server.Run(); }}
+    {
+    }
+
+    ~RunningServer()
+    {
+        Server.Stop();
+        Thread.join();
+    }
+
+    static Daemon::Options MakeOptions()
+    {
+        Daemon::Options options;
+        options.Threads = 2;
+        options.BufferSize = 4096;
+        options.TimeoutMs = 300;
+        return options;
+    }
+
+    const std::string Path;
+    Daemon::Server Server;
+    std::thread Thread;
+};
+
+TEST(Daemon, ShouldReportPercentiles)
+{
+    Daemon::Latency latency{100};
+    EXPECT_EQ(0.0, latency.Percentile(0.5));
+
+    for (int i = 1; i <= 200; ++i)
+    {
+        latency.Add(i);
+    }
+
+    // Only the most recent samples are kept.
+    EXPECT_EQ(200u, latency.Count());
+    EXPECT_EQ(150.0, latency.Percentile(0.5));
+    EXPECT_EQ(199.0, latency.Percentile(0.99));
+    EXPECT_EQ(200.0, latency.Percentile(1.0));
+    EXPECT_EQ(101.0, latency.Percentile(0.0));
+}
+
+TEST(Daemon, ShouldProcessInBandData)
+{
+    RunningServer server;
+    Daemon::Client client{server.Path};
+
+    const std::string source = "in-band data goes there and back, there and back";
+
+    // Several requests go over one connection.
+    for (int i = 0; i < 3; ++i)
+    {
+        auto encoded = client.Process(Operation::Encode, source);
+        EXPECT_NE(source, encoded);
+        EXPECT_EQ(source, client.Process(Operation::Decode, encoded));
+    }
+
+    EXPECT_EQ(6u, server.Server.Latencies().Count());
+    EXPECT_EQ(0u, client.Stats().find("requests 6, p50 "));
+}
+
+TEST(Daemon, ShouldProcessFiles)
+{
+    RunningServer server;
+    Daemon::Client first{server.Path};
+    Daemon::Client second{server.Path};
+
+    const std::string input = server.Path + ".in";
+    const std::string encoded = server.Path + ".huf";
+    const std::string decoded = server.Path + ".out";
+
+    const std::string source(100000, 'z');
+    std::ofstream{input, std::ios::binary} << source;
+
+    first.Process(Operation::Encode, input, encoded);
+    second.Process(Operation::Decode, encoded, decoded);
+
+    std::ifstream stream{decoded, std::ios::binary};
+    EXPECT_EQ(source, std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()));
+
+    std::remove(input.c_str());
+    std::remove(encoded.c_str());
+    std::remove(decoded.c_str());
+}
+
+TEST(Daemon, ShouldReportErrors)
+{
+    RunningServer server;
+    Daemon::Client client{server.Path};
+
+    EXPECT_THROW(client.Process(Operation::Decode, std::string("not encoded")), std::runtime_error);
+    EXPECT_THROW(client.Process(Operation::Encode, "/nonexistent/input", "/nonexistent/output"), std::runtime_error);
+
+    // Connection survives failed requests.
+    EXPECT_EQ("abc", client.Process(Operation::Decode, client.Process(Operation::Encode, std::string("abc"))));
+
+    // Second server can't take socket which is in use.
+    EXPECT_THROW(Daemon::Server(server.Path, Processor::Config{}), std::runtime_error);
+}
+
+TEST(Daemon, ShouldRefuseDataOverBudget)
+{
+    Budget::Tracker tracker{1024};
+    Processor::Config config;
+    config.Memory = &tracker;
+
+    RunningServer server{config};
+    Daemon::Client client{server.Path};
+
+    try
+    {
+        client.Process(Operation::Encode, std::string(4096, 'a'));
+        FAIL();
+    }
+    catch (const std::runtime_error& e)
+    {
+        EXPECT_STREQ("Budget: Memory limit is exceeded.", e.what());
+    }
+    EXPECT_EQ(0u, tracker.Used());
+}
+
+TEST(Daemon, ShouldDropStalledClients)
+{
+    // Each client sends a part of request and nothing more.
+    auto stall = [](const std::string& aPath) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        aPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+
+        int connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        EXPECT_EQ(0, ::connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+        EXPECT_EQ(3, ::send(connection, "abc", 3, 0));
+        return connection;
+    };
+
+    std::vector<int> stalled;
+    {
+        RunningServer server;
+        for (unsigned i = 0; i < RunningServer::MakeOptions().Threads; ++i)
+        {
+            stalled.push_back(stall(server.Path));
+        }
+
+        // Workers are given back after timeout.
+        Daemon::Client client{server.Path};
+        EXPECT_EQ("abc", client.Process(Operation::Decode, client.Process(Operation::Encode, std::string("abc"))));
+
+        // Server stops, while a client stalls.
+        stalled.push_back(stall(server.Path));
+    }
+
+    for (auto connection : stalled)
+    {
+        ::close(connection);
+    }
+}
+
+TEST(Daemon, ShouldDropClientsWhichDontRead)
+{
+    // Each client asks for more than socket holds and doesn't read it.
+    auto hoard = [](const std::string& aPath) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        aPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+
+        std::string data(4 * 1024 * 1024, '\0');
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<char>(i * 2654435761u >> 13);
+        }
+
+        Daemon::Request request{};
+        request.Magic = Daemon::Request::Signature;
+        request.Kind = Operation::Encode;
+        request.InBand = 1;
+        request.InputLength = data.size();
+
+        int connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        EXPECT_EQ(0, ::connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+        EXPECT_EQ(static_cast<ssize_t>(sizeof(request)), ::send(connection, &request, sizeof(request), 0));
+        for (ssize_t offset = 0, count = 1; count > 0 && offset < static_cast<ssize_t>(data.size()); offset += count)
+        {
+            count = ::send(connection, data.data() + offset, data.size() - offset, 0);
+            EXPECT_GT(count, 0);
+        }
+        return connection;
+    };
+
+    std::vector<int> hoarding;
+    {
+        RunningServer server;
+        for (unsigned i = 0; i < RunningServer::MakeOptions().Threads; ++i)
+        {
+            hoarding.push_back(hoard(server.Path));
+        }
+
+        // Workers are given back after timeout.
+        Daemon::Client client{server.Path};
+        EXPECT_EQ("abc", client.Process(Operation::Decode, client.Process(Operation::Encode, std::string("abc"))));
+    }
+
+    for (auto connection : hoarding)
+    {
+        ::close(connection);
+    }
+}
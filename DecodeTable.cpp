@@ -0,0 +1,102 @@
+#include <algorithm>
+
+#include "DecodeTable.hpp"
+
+namespace Helpers
+{
+    DecodeTable::DecodeTable(const SymbolInfo* aBegin, const SymbolInfo* aEnd, unsigned aPeekBits, unsigned aSymbols)
+    {
+        if (aPeekBits == 0 || aPeekBits > MaxPeekBits || aSymbols == 0 || aSymbols > MaxSymbols)
+        {
+            throw std::invalid_argument("DecodeTable: Invalid options.");
+        }
+
+        auto valid = [](const SymbolInfo& aInfo) {
+            return aInfo.Code.Length > 0 && aInfo.Code.Length <= MaxCodeLength;
+        };
+
+        for (auto it = aBegin; it != aEnd; ++it)
+        {
+            if (valid(*it))
+            {
+                mMaxLength = std::max(mMaxLength, static_cast<unsigned>(it->Code.Length));
+            }
+        }
+
+        // Single symbol entries don't need to peek more than the longest
+        // code, while longer peek lets several short codes share an entry.
+        mPeekBits = mMaxLength == 0 ? 1 : aSymbols == 1 ? std::min(aPeekBits, mMaxLength) : aPeekBits;
+
+        // Each code fills all entries which it is a prefix of.
+        std::vector<Entry> single(size_t{1} << mPeekBits, Entry{});
+
+        for (auto it = aBegin; it != aEnd; ++it)
+        {
+            if (!valid(*it))
+            {
+                continue;
+            }
+
+            const auto length = static_cast<unsigned>(it->Code.Length);
+
+            if (length > mPeekBits)
+            {
+                mLong.Put(*it);
+                continue;
+            }
+
+            const auto value = static_cast<uint32_t>(it->Code.Value) & ((1u << length) - 1);
+            const auto shift = mPeekBits - length;
+
+            Entry entry{};
+            entry.Symbols[0] = it->Symbol;
+            entry.Count = 1;
+            entry.Bits = static_cast<uint8_t>(length);
+            entry.FirstBits = entry.Bits;
+
+            std::fill(single.begin() + (value << shift), single.begin() + ((value + 1) << shift), entry);
+        }
+
+        // Then more symbols are appended, while they fit into the rest of peek.
+        mEntries = single;
+
+        if (aSymbols == 1)
+        {
+            return;
+        }
+
+        const auto mask = (1u << mPeekBits) - 1;
+
+        for (uint32_t index = 0; index < mEntries.size(); ++index)
+        {
+            auto& entry = mEntries[index];
+
+            while (entry.Count && entry.Count < aSymbols && entry.Bits < mPeekBits)
+            {
+                const auto& next = single[(index << entry.Bits) & mask];
+                if (!next.Count || entry.Bits + next.Bits > mPeekBits)
+                {
+                    break;
+                }
+
+                entry.Symbols[entry.Count++] = next.Symbols[0];
+                entry.Bits += next.Bits;
+            }
+        }
+    }
+
+    unsigned DecodeTable::PeekBits() const
+    {
+        return mPeekBits;
+    }
+
+    unsigned DecodeTable::MaxLength() const
+    {
+        return mMaxLength;
+    }
+
+    const SymbolsLookup& DecodeTable::Long() const
+    {
+        return mLong;
+    }
+}
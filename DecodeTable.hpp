@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "Model.hpp"
+#include "SymbolsLookup.hpp"
+
+namespace Helpers
+{
+    // Lookup table for N-bit peek of encoded stream. Each entry holds
+    // up to MaxSymbols complete symbols, which fit into peeked bits,
+    // and number of bits they take. Longer codes are looked up bit by bit.
+    class DecodeTable
+    {
+    public:
+        static constexpr unsigned DefaultPeekBits = 11;
+        static constexpr unsigned MaxPeekBits = 16;
+        static constexpr unsigned MaxSymbols = 4;
+
+        // Encoder never makes longer codes.
+        static constexpr int MaxCodeLength = 32;
+
+        struct Entry
+        {
+            uint8_t Symbols[MaxSymbols];
+            uint8_t Count;
+            uint8_t Bits;
+            uint8_t FirstBits;
+        };
+
+        DecodeTable() = default;
+        DecodeTable(const SymbolInfo* aBegin, const SymbolInfo* aEnd, unsigned aPeekBits = DefaultPeekBits,
+                    unsigned aSymbols = MaxSymbols);
+
+        const Entry& Find(uint32_t aPeek) const
+        {
+            return mEntries[aPeek];
+        }
+
+        unsigned PeekBits() const;
+        unsigned MaxLength() const;
+
+        const SymbolsLookup& Long() const;
+
+    private:
+        unsigned mPeekBits{1};
+        unsigned mMaxLength{0};
+
+        std::vector<Entry> mEntries{2, Entry{}};
+        SymbolsLookup mLong;
+    };
+
+    // Decodes stream, which is fed in chunks of any size.
+    // Bits of incomplete code are kept between chunks.
+    class SymbolsDecoder
+    {
+    public:
+        struct Result
+        {
+            size_t Consumed;
+            size_t Produced;
+        };
+
+        explicit SymbolsDecoder(const DecodeTable& aTable)
+          : mTable{&aTable}
+        {
+        }
+
+        // Decodes up to aLimit symbols. At the end of stream aFinal allows
+        // to decode codes from the last bits, which are fewer than peek.
+        // Sink must provide Reserve(size) and Commit(count).
+        template <typename TSink>
+        Result Decode(const char* aData, size_t aSize, size_t aLimit, bool aFinal, TSink& aSink);
+
+        // Drops remaining bits, e.g. padding of byte aligned block.
+        void Reset()
+        {
+            mBits = 0;
+            mCount = 0;
+        }
+
+    private:
+        template <typename TSink>
+        bool DecodeLong(TSink& aSink);
+
+    private:
+        const DecodeTable* mTable;
+
+        uint64_t mBits{0};
+        unsigned mCount{0};
+    };
+
+    template <typename TSink>
+    SymbolsDecoder::Result SymbolsDecoder::Decode(const char* aData, size_t aSize, size_t aLimit, bool aFinal, TSink& aSink)
+    {
+        const auto peek = mTable->PeekBits();
+        const auto mask = (uint64_t{1} << peek) - 1;
+        const auto data = reinterpret_cast<const uint8_t*>(aData);
+
+        size_t consumed = 0;
+        size_t produced = 0;
+
+        while (produced < aLimit)
+        {
+            if (aSize - consumed >= 8 && mCount <= 56)
+            {
+                // Take as many whole bytes as fit at once.
+                uint64_t word = 0;
+                for (int i = 0; i < 8; ++i)
+                {
+                    word = (word << 8) | data[consumed + i];
+                }
+
+                auto bytes = (64 - mCount) / 8;
+                mBits = bytes == 8 ? word : (mBits << (bytes * 8)) | (word >> (64 - bytes * 8));
+                mCount += bytes * 8;
+                consumed += bytes;
+            }
+            else
+            {
+                while (mCount <= 56 && consumed < aSize)
+                {
+                    mBits = (mBits << 8) | data[consumed++];
+                    mCount += 8;
+                }
+            }
+
+            if (mCount >= peek)
+            {
+                const auto& entry = mTable->Find(static_cast<uint32_t>((mBits >> (mCount - peek)) & mask));
+                if (entry.Count && entry.Count <= aLimit - produced)
+                {
+                    std::memcpy(aSink.Reserve(DecodeTable::MaxSymbols), entry.Symbols, DecodeTable::MaxSymbols);
+                    aSink.Commit(entry.Count);
+
+                    produced += entry.Count;
+                    mCount -= entry.Bits;
+                    continue;
+                }
+
+                // Limit cuts entry, bits of the rest of it stay for the next call.
+                if (entry.Count)
+                {
+                    *aSink.Reserve(1) = static_cast<char>(entry.Symbols[0]);
+                    aSink.Commit(1);
+
+                    produced++;
+                    mCount -= entry.FirstBits;
+                    continue;
+                }
+
+                if (DecodeLong(aSink))
+                {
+                    produced++;
+                    continue;
+                }
+
+                if (mCount >= mTable->MaxLength() || (aFinal && consumed == aSize))
+                {
+                    throw std::runtime_error("Decoder: Invalid code.");
+                }
+
+                break;
+            }
+
+            if (consumed < aSize || !aFinal || mCount == 0)
+            {
+                break;
+            }
+
+            // Fewer bits than peek are left, last of them may be padding.
+            const auto& entry = mTable->Find(static_cast<uint32_t>((mBits << (peek - mCount)) & mask));
+            if (!entry.Count && mCount >= mTable->MaxLength())
+            {
+                throw std::runtime_error("Decoder: Invalid code.");
+            }
+
+            if (!entry.Count || entry.FirstBits > mCount)
+            {
+                break;
+            }
+
+            *aSink.Reserve(1) = static_cast<char>(entry.Symbols[0]);
+            aSink.Commit(1);
+
+            produced++;
+            mCount -= entry.FirstBits;
+        }
+
+        return Result{consumed, produced};
+    }
+
+    template <typename TSink>
+    bool SymbolsDecoder::DecodeLong(TSink& aSink)
+    {
+        const auto max = mCount < mTable->MaxLength() ? mCount : mTable->MaxLength();
+
+        for (auto length = mTable->PeekBits() + 1; length <= max; ++length)
+        {
+            auto value = static_cast<uint32_t>((mBits >> (mCount - length)) & ((uint64_t{1} << length) - 1));
+
+            auto find = mTable->Long().Find(static_cast<int>(value), static_cast<int>(length));
+            if (find.Success)
+            {
+                *aSink.Reserve(1) = static_cast<char>(find.Symbol);
+                aSink.Commit(1);
+
+                mCount -= length;
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,150 @@
+#include "DecodeTable.hpp"
+#include "TestsBase.hpp"
+
+using Helpers::DecodeTable;
+using Helpers::SymbolsDecoder;
+using Model::SymbolInfo;
+
+namespace
+{
+    // Codes: a - 0, b - 10, c - 110, d - 111.
+    const SymbolInfo Entries[] = {{'a', {0, 1}}, {'b', {2, 2}}, {'c', {6, 3}}, {'d', {7, 3}}};
+
+    struct Sink
+    {
+        char* Reserve(size_t aSize)
+        {
+            Data.resize(Size + aSize);
+            return &Data[Size];
+        }
+
+        void Commit(size_t aCount)
+        {
+            Size += aCount;
+            Data.resize(Size);
+        }
+
+        std::string Data;
+        size_t Size{0};
+    };
+
+    // Packs string of '0' and '1' into bytes, last byte is padded by zeros.
+    std::string Pack(const std::string& aBits)
+    {
+        std::string result((aBits.size() + 7) / 8, '\0');
+        for (size_t i = 0; i < aBits.size(); ++i)
+        {
+            if (aBits[i] == '1')
+            {
+                result[i / 8] = static_cast<char>(result[i / 8] | (0x80 >> (i % 8)));
+            }
+        }
+        return result;
+    }
+}
+
+TEST(DecodeTable, ShouldHoldSingleSymbolPerEntryIfAsked)
+{
+    DecodeTable table{std::begin(Entries), std::end(Entries), 3, 1};
+
+    EXPECT_EQ(3u, table.PeekBits());
+    EXPECT_EQ(3u, table.MaxLength());
+
+    const auto& entry = table.Find(0b010);
+    EXPECT_EQ(1u, entry.Count);
+    EXPECT_EQ('a', entry.Symbols[0]);
+    EXPECT_EQ(1u, entry.Bits);
+
+    EXPECT_EQ('d', table.Find(0b111).Symbols[0]);
+    EXPECT_EQ(3u, table.Find(0b111).Bits);
+}
+
+TEST(DecodeTable, ShouldHoldSeveralSymbolsPerEntry)
+{
+    DecodeTable table{std::begin(Entries), std::end(Entries), 4, 4};
+
+    const auto& zeros = table.Find(0b0000);
+    EXPECT_EQ(4u, zeros.Count);
+    EXPECT_EQ(4u, zeros.Bits);
+    EXPECT_EQ(1u, zeros.FirstBits);
+
+    const auto& mixed = table.Find(0b0100);
+    ASSERT_EQ(3u, mixed.Count);
+    EXPECT_EQ('a', mixed.Symbols[0]);
+    EXPECT_EQ('b', mixed.Symbols[1]);
+    EXPECT_EQ('a', mixed.Symbols[2]);
+    EXPECT_EQ(4u, mixed.Bits);
+}
+
+TEST(DecodeTable, ShouldDecodeCodesLongerThanPeek)
+{
+    DecodeTable table{std::begin(Entries), std::end(Entries), 2, 4};
+    ASSERT_EQ(2u, table.PeekBits());
+
+    auto data = Pack("0" "10" "110" "111" "110");
+
+    Sink sink;
+    SymbolsDecoder decoder{table};
+    auto result = decoder.Decode(data.data(), data.size(), 5, true, sink);
+
+    EXPECT_EQ(5u, result.Produced);
+    EXPECT_EQ("abcdc", sink.Data);
+}
+
+TEST(DecodeTable, ShouldResumeDecodingOnChunkBoundaries)
+{
+    std::string bits, expected;
+    const char* codes[] = {"0", "10", "110", "111"};
+    for (int i = 0; i < 500; ++i)
+    {
+        auto index = (i * 7 + i / 3) % 4;
+        bits += codes[index];
+        expected.push_back(static_cast<char>('a' + index));
+    }
+
+    auto data = Pack(bits);
+
+    DecodeTable table{std::begin(Entries), std::end(Entries)};
+    SymbolsDecoder decoder{table};
+
+    Sink sink;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        decoder.Decode(&data[i], 1, expected.size() - sink.Size, false, sink);
+    }
+    decoder.Decode(nullptr, 0, expected.size() - sink.Size, true, sink);
+
+    EXPECT_EQ(expected, sink.Data);
+}
+
+TEST(DecodeTable, ShouldThrowOnInvalidCode)
+{
+    // Code 11 is not used by any symbol.
+    const SymbolInfo entries[] = {{'a', {0, 1}}, {'b', {2, 2}}};
+    DecodeTable table{std::begin(entries), std::end(entries)};
+
+    auto data = Pack("0" "11" "0");
+
+    Sink sink;
+    SymbolsDecoder decoder{table};
+    EXPECT_THROW(decoder.Decode(data.data(), data.size(), 4, true, sink), std::runtime_error);
+}
+
+TEST(DecodeTable, ShouldKeepRestOfEntryCutByLimit)
+{
+    DecodeTable table{std::begin(Entries), std::end(Entries), 8, 4};
+    SymbolsDecoder decoder{table};
+
+    // a b a c d a a b, each entry takes several of them.
+    const auto data = Pack("01001101110010");
+
+    Sink sink;
+    for (size_t offset = 0; sink.Size < 8;)
+    {
+        auto result = decoder.Decode(data.data() + offset, data.size() - offset, 1, true, sink);
+        ASSERT_EQ(1u, result.Produced);
+        offset += result.Consumed;
+    }
+
+    EXPECT_EQ("abacdaab", sink.Data);
+}
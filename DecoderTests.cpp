@@ -10,6 +10,8 @@ struct InputFileMock : IStorage::Input
     MOCK_METHOD1(ReadTo, bool(IStorage::Input::TBuffer* const));
     MOCK_METHOD2(Read, size_t(char*, const size_t));
     MOCK_METHOD0(Reset, void());
+    MOCK_METHOD3(ReadAt, size_t(const size_t, char*, const size_t));
+    MOCK_METHOD0(Size, size_t());
 };
 
 struct OutputFileMock : IStorage::Output
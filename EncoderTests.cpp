@@ -1,4 +1,5 @@
 #include "Interfaces.hpp"
+#include "Memory.hpp"
 #include "Processor.hpp"
 #include "TestsBase.hpp"
 
@@ -10,6 +11,8 @@ struct InputFileMock : IStorage::Input
     MOCK_METHOD1(ReadTo, bool(IStorage::Input::TBuffer* const));
     MOCK_METHOD2(Read, size_t(char*, size_t));
     MOCK_METHOD0(Reset, void());
+    MOCK_METHOD3(ReadAt, size_t(size_t, char*, size_t));
+    MOCK_METHOD0(Size, size_t());
 };
 
 struct OutputFileMock : IStorage::Output
@@ -138,3 +141,64 @@ TEST(Encoder, ShouldEncodeSimpleStream)
     Processor::Encode(input, output);
 }
 
+
+TEST(Encoder, ShouldEncodeSymbolsMissedBySample)
+{
+    // Given large source with a few rare symbols.
+    std::string source(1024 * 1024, 'A');
+    for (size_t i = 0; i < source.size(); i += 3)
+    {
+        source[i] = 'B';
+    }
+    source[5000] = 'Z';
+    source[source.size() / 2 + 7] = '\xFF';
+
+    // When we build histogram from small sample only.
+    Processor::Config config;
+    config.Sample.Fraction = 0.1;
+    config.Sample.ChunkSize = 1024;
+
+    Memory::Reader input{source};
+    Memory::Writer encoded;
+    Processor::Encode(input, encoded, config);
+
+    // We expect that every symbol has a code, and source is restored.
+    auto header = reinterpret_cast<const FileHeader*>(encoded.Data().data());
+    EXPECT_EQ(256u, header->Table.Length);
+
+    Memory::Reader reader{encoded.Data()};
+    Memory::Writer decoded;
+    Processor::Decode(reader, decoded);
+
+    EXPECT_EQ(source, decoded.Data());
+}
+
+TEST(Encoder, ShouldCountSymbolsInSeveralThreads)
+{
+    // Given source with skewed symbols distribution.
+    std::string source(512 * 1024, 'A');
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        source[i] = static_cast<char>('A' + i % 7 * i % 5);
+    }
+
+    Memory::Reader input{source};
+    Memory::Writer sequential;
+    Processor::Encode(input, sequential);
+
+    // When we count symbols in several threads.
+    Processor::Config config;
+    config.Threads = 4;
+
+    Memory::Writer encoded;
+    Processor::Encode(input, encoded, config);
+
+    // We expect same compression and source is restored.
+    EXPECT_EQ(sequential.Data().size(), encoded.Data().size());
+
+    Memory::Reader reader{encoded.Data()};
+    Memory::Writer decoded;
+    Processor::Decode(reader, decoded);
+
+    EXPECT_EQ(source, decoded.Data());
+}
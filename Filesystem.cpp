@@ -1,3 +1,17 @@
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "Filesystem.hpp"
 
 namespace Filesystem
@@ -6,12 +20,24 @@ namespace Filesystem
 
     Reader::Reader(const std::string& aName)
       : mStream{aName, std::ios::in | std::ios::binary}
+#ifdef _WIN32
+      , mRandomAccessStream{aName, std::ios::in | std::ios::binary}
+#else
+      , mDescriptor{::open(aName.c_str(), O_RDONLY)}
+#endif
     {
     }
 
     Reader::~Reader()
     {
         mStream.close();
+
+#ifndef _WIN32
+        if (mDescriptor >= 0)
+        {
+            ::close(mDescriptor);
+        }
+#endif
     }
 
     bool Reader::ReadTo(TBuffer* aBuffer)
@@ -43,6 +69,49 @@ namespace Filesystem
         mStream.seekg(0, std::ios_base::beg);
     }
 
+    size_t Reader::ReadAt(size_t aOffset, char* aBuffer, size_t aSize)
+    {
+#ifdef _WIN32
+        std::lock_guard<std::mutex> lock{mRandomAccessMutex};
+
+        mRandomAccessStream.clear();
+        mRandomAccessStream.seekg(aOffset, std::ios_base::beg);
+        mRandomAccessStream.read(aBuffer, aSize);
+
+        return mRandomAccessStream.gcount();
+#else
+        size_t count = 0;
+        while (count < aSize)
+        {
+            auto result = ::pread(mDescriptor, aBuffer + count, aSize - count, aOffset + count);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                break;
+            }
+            count += result;
+        }
+        return count;
+#endif
+    }
+
+    size_t Reader::Size()
+    {
+        auto position = mStream.tellg();
+
+        mStream.clear();
+        mStream.seekg(0, std::ios_base::end);
+        auto size = mStream.tellg();
+
+        mStream.clear();
+        mStream.seekg(position < 0 ? std::streampos{0} : position);
+
+        return size < 0 ? 0 : static_cast<size_t>(size);
+    }
+
     Writer::Writer(const std::string& aName)
       : mStream{aName, std::ios::out | std::ios::binary}
     {
@@ -73,4 +142,90 @@ namespace Filesystem
         mStream.clear();
         mStream.seekp(0, std::ios_base::beg);
     }
+
+    std::vector<std::string> List(const std::string& aDirectory)
+    {
+        std::vector<std::string> names;
+
+#ifdef _WIN32
+        WIN32_FIND_DATAA data;
+        auto handle = ::FindFirstFileA((aDirectory + "\\*").c_str(), &data);
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Filesystem: Can't list directory.");
+        }
+
+        do
+        {
+            if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            {
+                names.emplace_back(data.cFileName);
+            }
+        } while (::FindNextFileA(handle, &data));
+
+        ::FindClose(handle);
+#else
+        auto directory = ::opendir(aDirectory.c_str());
+        if (!directory)
+        {
+            throw std::runtime_error("Filesystem: Can't list directory.");
+        }
+
+        while (auto entry = ::readdir(directory))
+        {
+            struct stat info;
+            if (::stat((aDirectory + "/" + entry->d_name).c_str(), &info) == 0 && S_ISREG(info.st_mode))
+            {
+                names.emplace_back(entry->d_name);
+            }
+        }
+
+        ::closedir(directory);
+#endif
+
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    bool IsDirectory(const std::string& aName)
+    {
+#ifdef _WIN32
+        auto attributes = ::GetFileAttributesA(aName.c_str());
+        return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+        struct stat info;
+        return ::stat(aName.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+    }
+
+    size_t SizeOf(const std::string& aName)
+    {
+        std::ifstream stream{aName, std::ios::in | std::ios::binary | std::ios::ate};
+        auto size = stream.tellg();
+        return size < 0 ? 0 : static_cast<size_t>(size);
+    }
+
+    std::string Absolute(const std::string& aName)
+    {
+#ifdef _WIN32
+        char buffer[MAX_PATH];
+        if (!::GetFullPathNameA(aName.c_str(), MAX_PATH, buffer, nullptr))
+        {
+            throw std::runtime_error("Filesystem: Can't resolve " + aName + ".");
+        }
+        return buffer;
+#else
+        if (!aName.empty() && aName[0] == '/')
+        {
+            return aName;
+        }
+
+        std::vector<char> buffer(4096);
+        if (!::getcwd(buffer.data(), buffer.size()))
+        {
+            throw std::runtime_error("Filesystem: Can't resolve " + aName + ".");
+        }
+        return std::string(buffer.data()) + "/" + aName;
+#endif
+    }
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "Interfaces.hpp"
 
@@ -18,9 +21,18 @@ namespace Filesystem
         virtual bool ReadTo(TBuffer* aBuffer) override;
         virtual size_t Read(char* aBuffer, size_t aSize) override;
         virtual void Reset() override;
+        virtual size_t ReadAt(size_t aOffset, char* aBuffer, size_t aSize) override;
+        virtual size_t Size() override;
 
     private:
         std::ifstream mStream;
+
+#ifdef _WIN32
+        std::mutex mRandomAccessMutex;
+        std::ifstream mRandomAccessStream;
+#else
+        int mDescriptor{-1};
+#endif
     };
 
     struct Writer final : IStorage::Output
@@ -39,4 +51,15 @@ namespace Filesystem
     private:
         std::ofstream mStream;
     };
+
+    // Sorted names of regular files in directory.
+    std::vector<std::string> List(const std::string& aDirectory);
+
+    bool IsDirectory(const std::string& aName);
+
+    // Returns 0 if file can't be opened.
+    size_t SizeOf(const std::string& aName);
+
+    // Prepends current directory to relative name.
+    std::string Absolute(const std::string& aName);
 }
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "FlatTree.hpp"
+
+namespace Huffman
+{
+    FlatTreeBuilder::FlatTreeBuilder(int aMaxLength)
+      : mMaxLength{aMaxLength}
+    {
+        // Any 256 symbols must fit into codes of given length.
+        if (aMaxLength < 8 || aMaxLength > MaxCodeLength)
+        {
+            throw std::invalid_argument("FlatTreeBuilder: Invalid max code length.");
+        }
+    }
+
+    const FlatTreeBuilder::TCodes& FlatTreeBuilder::Build(const THistogram& aFrequencies)
+    {
+        mCodes.fill(SymbolCode{0, 0});
+        mLengthCounts.fill(0);
+
+        // Leaves go first, sorted by frequency.
+        mCount = 0;
+        for (size_t symbol = 0; symbol < aFrequencies.size(); ++symbol)
+        {
+            if (aFrequencies[symbol])
+            {
+                mSymbols[mCount++] = static_cast<uint16_t>(symbol);
+            }
+        }
+
+        if (mCount == 0)
+        {
+            return mCodes;
+        }
+
+        if (mCount == 1)
+        {
+            mCodes[mSymbols[0]] = SymbolCode{0, 1};
+            return mCodes;
+        }
+
+        std::sort(mSymbols.begin(), mSymbols.begin() + mCount, [&aFrequencies](uint16_t lhs, uint16_t rhs) {
+            return aFrequencies[lhs] < aFrequencies[rhs] || (aFrequencies[lhs] == aFrequencies[rhs] && lhs < rhs);
+        });
+
+        for (size_t i = 0; i < mCount; ++i)
+        {
+            mFrequencies[i] = aFrequencies[mSymbols[i]];
+        }
+
+        // Merged nodes are created in non-decreasing frequency order,
+        // so they form the second sorted queue right after the leaves.
+        size_t leaf = 0;
+        size_t merged = mCount;
+
+        auto take = [this, &leaf, &merged](size_t aEnd) {
+            if (leaf < mCount && (merged == aEnd || mFrequencies[leaf] <= mFrequencies[merged]))
+            {
+                return leaf++;
+            }
+            return merged++;
+        };
+
+        const auto root = 2 * mCount - 2;
+        for (auto node = mCount; node <= root; ++node)
+        {
+            auto left = take(node);
+            auto right = take(node);
+
+            mFrequencies[node] = mFrequencies[left] + mFrequencies[right];
+            mParents[left] = static_cast<uint16_t>(node);
+            mParents[right] = static_cast<uint16_t>(node);
+        }
+
+        // Parent always has greater index than its children, so depths
+        // are resolved in one backward pass. Parents are replaced by depths.
+        mParents[root] = 0;
+        for (auto node = root; node-- > 0;)
+        {
+            mParents[node] = mParents[mParents[node]] + 1;
+        }
+
+        for (size_t i = 0; i < mCount; ++i)
+        {
+            mLengthCounts[mParents[i]]++;
+        }
+
+        LimitLengths();
+        AssignCodes();
+
+        return mCodes;
+    }
+
+    const FlatTreeBuilder::TCodes& FlatTreeBuilder::Codes() const
+    {
+        return mCodes;
+    }
+
+    size_t FlatTreeBuilder::Count() const
+    {
+        return mCount;
+    }
+
+    void FlatTreeBuilder::LimitLengths()
+    {
+        const auto max = static_cast<size_t>(mMaxLength);
+
+        for (auto length = max + 1; length < mLengthCounts.size(); ++length)
+        {
+            mLengthCounts[max] += mLengthCounts[length];
+            mLengthCounts[length] = 0;
+        }
+
+        // Restore Kraft equality: every step moves one code from the
+        // deepest level and splits one shorter leaf into two.
+        uint64_t total = 0;
+        for (size_t length = 1; length <= max; ++length)
+        {
+            total += static_cast<uint64_t>(mLengthCounts[length]) << (max - length);
+        }
+
+        while (total > (uint64_t{1} << max))
+        {
+            mLengthCounts[max]--;
+
+            for (auto length = max - 1; length > 0; --length)
+            {
+                if (mLengthCounts[length])
+                {
+                    mLengthCounts[length]--;
+                    mLengthCounts[length + 1] += 2;
+                    break;
+                }
+            }
+
+            total--;
+        }
+    }
+
+    void FlatTreeBuilder::AssignCodes()
+    {
+        // Least frequent leaves get longest codes.
+        size_t leaf = 0;
+        for (auto length = mMaxLength; length > 0; --length)
+        {
+            for (auto count = mLengthCounts[length]; count > 0; --count)
+            {
+                mCodes[mSymbols[leaf++]].Length = length;
+            }
+        }
+
+        AssignCanonical(mCodes);
+    }
+
+    bool AssignCanonical(FlatTreeBuilder::TCodes& aCodes)
+    {
+        std::array<uint64_t, FlatTreeBuilder::MaxCodeLength + 1> counts{};
+
+        uint64_t total = 0;
+        for (const auto& item : aCodes)
+        {
+            if (item.Length < 0 || item.Length > FlatTreeBuilder::MaxCodeLength)
+            {
+                return false;
+            }
+
+            if (item.Length)
+            {
+                counts[item.Length]++;
+                total += uint64_t{1} << (FlatTreeBuilder::MaxCodeLength - item.Length);
+            }
+        }
+
+        // Kraft sum above one means some codes are prefixes of others.
+        if (total > uint64_t{1} << FlatTreeBuilder::MaxCodeLength)
+        {
+            return false;
+        }
+
+        // Canonical codes are consecutive within each length,
+        // in order of symbols.
+        std::array<uint64_t, FlatTreeBuilder::MaxCodeLength + 1> next{};
+
+        uint64_t code = 0;
+        for (auto length = 1; length <= FlatTreeBuilder::MaxCodeLength; ++length)
+        {
+            code = (code + counts[length - 1]) << 1;
+            next[length] = code;
+        }
+
+        for (auto& item : aCodes)
+        {
+            if (item.Length)
+            {
+                item.Value = static_cast<int>(next[item.Length]++);
+            }
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "HuffmanTree.hpp"
+#include "Model.hpp"
+
+namespace Huffman
+{
+    // Builds canonical codes for given histogram.
+    // Leaves are sorted once and merged with two queues in linear time.
+    // All nodes live in flat arrays, so Build() never allocates.
+    class FlatTreeBuilder
+    {
+    public:
+        using TCodes = std::array<SymbolCode, 256>;
+
+        static constexpr int MaxCodeLength = 32;
+
+        explicit FlatTreeBuilder(int aMaxLength = MaxCodeLength);
+
+        const TCodes& Build(const THistogram& aFrequencies);
+
+        const TCodes& Codes() const;
+        size_t Count() const;
+
+    private:
+        void LimitLengths();
+        void AssignCodes();
+
+    private:
+        static constexpr size_t MaxNodes = 2 * 256 - 1;
+
+        int mMaxLength;
+        size_t mCount{0};
+
+        std::array<uint16_t, 256> mSymbols{};
+        std::array<size_t, MaxNodes> mFrequencies{};
+        std::array<uint16_t, MaxNodes> mParents{};
+
+        // Number of codes of each length, max possible depth is 255.
+        std::array<uint32_t, 256> mLengthCounts{};
+
+        TCodes mCodes{};
+    };
+
+    // Assigns canonical values to codes by their lengths. Returns false,
+    // if lengths are out of range or can't make a prefix code.
+    bool AssignCanonical(FlatTreeBuilder::TCodes& aCodes);
+}
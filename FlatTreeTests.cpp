@@ -0,0 +1,126 @@
+#include <numeric>
+
+#include "FlatTree.hpp"
+#include "TestsBase.hpp"
+
+using Huffman::FlatTreeBuilder;
+using Huffman::THistogram;
+
+THistogram MakeHistogram(const std::string& aSource)
+{
+    THistogram histogram{};
+    for (const auto& c : aSource)
+    {
+        histogram[static_cast<Model::TSymbol>(c)]++;
+    }
+    return histogram;
+}
+
+// Sum of 2^-length over all codes, scaled by 2^32.
+uint64_t KraftSum(const FlatTreeBuilder::TCodes& aCodes)
+{
+    uint64_t sum = 0;
+    for (const auto& code : aCodes)
+    {
+        if (code.Length)
+        {
+            sum += uint64_t{1} << (32 - code.Length);
+        }
+    }
+    return sum;
+}
+
+TEST(FlatTree, ShouldBuildNothingIfNoDataWasGiven)
+{
+    FlatTreeBuilder builder;
+    builder.Build(MakeHistogram(""));
+
+    EXPECT_EQ(0u, builder.Count());
+    EXPECT_EQ(0u, KraftSum(builder.Codes()));
+}
+
+TEST(FlatTree, ShouldCalculateCodeForOneSymbol)
+{
+    FlatTreeBuilder builder;
+    const auto& codes = builder.Build(MakeHistogram("AAA"));
+
+    EXPECT_EQ(1u, builder.Count());
+    EXPECT_EQ(0b0, codes['A'].Value);
+    EXPECT_EQ(1, codes['A'].Length);
+}
+
+TEST(FlatTree, ShouldCalculateCanonicalCodes)
+{
+    FlatTreeBuilder builder;
+    const auto& codes = builder.Build(MakeHistogram("AAAABBC"));
+
+    ASSERT_EQ(3u, builder.Count());
+    EXPECT_EQ(0b0, codes['A'].Value);
+    EXPECT_EQ(1, codes['A'].Length);
+    EXPECT_EQ(0b10, codes['B'].Value);
+    EXPECT_EQ(2, codes['B'].Length);
+    EXPECT_EQ(0b11, codes['C'].Value);
+    EXPECT_EQ(2, codes['C'].Length);
+}
+
+TEST(FlatTree, ShouldBeAsGoodAsTreeBuilder)
+{
+    std::string source;
+    for (int i = 0; i < 200; ++i)
+    {
+        source.append(static_cast<size_t>(i * i % 97 + 1), static_cast<char>(i));
+    }
+
+    auto histogram = MakeHistogram(source);
+
+    Huffman::TreeBuilder tree;
+    tree.Process(std::vector<Model::TSymbol>(source.begin(), source.end()));
+    auto expected = tree.Build();
+
+    FlatTreeBuilder builder;
+    const auto& codes = builder.Build(histogram);
+
+    size_t expectedBits = 0;
+    size_t actualBits = 0;
+    for (size_t symbol = 0; symbol < histogram.size(); ++symbol)
+    {
+        if (histogram[symbol])
+        {
+            expectedBits += histogram[symbol] * expected.Codes[static_cast<Model::TSymbol>(symbol)].Length;
+            actualBits += histogram[symbol] * codes[symbol].Length;
+        }
+    }
+
+    EXPECT_EQ(expectedBits, actualBits);
+    EXPECT_EQ(uint64_t{1} << 32, KraftSum(codes));
+}
+
+TEST(FlatTree, ShouldLimitCodeLength)
+{
+    // Fibonacci frequencies give the deepest possible tree.
+    THistogram histogram{};
+    histogram[0] = 1;
+    histogram[1] = 1;
+    for (size_t i = 2; i < 40; ++i)
+    {
+        histogram[i] = histogram[i - 1] + histogram[i - 2];
+    }
+
+    FlatTreeBuilder builder{12};
+    const auto& codes = builder.Build(histogram);
+
+    ASSERT_EQ(40u, builder.Count());
+    for (size_t i = 0; i < 40; ++i)
+    {
+        EXPECT_GE(12, codes[i].Length);
+        EXPECT_LT(0, codes[i].Length);
+    }
+    EXPECT_EQ(uint64_t{1} << 32, KraftSum(codes));
+    EXPECT_EQ(1, codes[39].Length);
+}
+
+TEST(FlatTree, ShouldRejectInvalidMaxLength)
+{
+    EXPECT_ANY_THROW(FlatTreeBuilder{7});
+    EXPECT_ANY_THROW(FlatTreeBuilder{33});
+}
@@ -2,13 +2,66 @@
 #include <queue>
 
 #include "HuffmanTree.hpp"
+#include "Kernels.hpp"
 
 void Huffman::TreeBuilder::Process(const std::vector<TSymbol>& aData)
 {
-    for (const auto& symbol : aData)
+    Process(aData.data(), aData.size());
+}
+
+void Huffman::TreeBuilder::Process(const TSymbol* aData, size_t aSize)
+{
+    Kernels::Histogram(aData, aSize, mFrequencies.data());
+}
+
+void Huffman::TreeBuilder::Smooth()
+{
+    for (int symbol = 0; symbol < 256; ++symbol)
+    {
+        mFrequencies[static_cast<TSymbol>(symbol)]++;
+    }
+}
+
+Huffman::THistogram& Huffman::TreeBuilder::Partial()
+{
+    std::lock_guard<std::mutex> lock{mPartialsMutex};
+
+    mPartials.emplace_back();
+    return mPartials.back();
+}
+
+std::unordered_map<Huffman::TSymbol, size_t> Huffman::TreeBuilder::Reduce() const
+{
+    auto histogram = mFrequencies;
+
+    for (const auto& partial : mPartials)
+    {
+        for (size_t symbol = 0; symbol < partial.size(); ++symbol)
+        {
+            histogram[symbol] += partial[symbol];
+        }
+    }
+
+    std::unordered_map<TSymbol, size_t> frequencies;
+    for (size_t symbol = 0; symbol < histogram.size(); ++symbol)
+    {
+        if (histogram[symbol])
+        {
+            frequencies[static_cast<TSymbol>(symbol)] = histogram[symbol];
+        }
+    }
+
+    return frequencies;
+}
+
+Huffman::THistogram Huffman::TreeBuilder::Histogram() const
+{
+    THistogram histogram{};
+    for (const auto& item : Reduce())
     {
-        mFrequencies[symbol]++;
+        histogram[item.first] = item.second;
     }
+    return histogram;
 }
 
 Huffman::Tree Huffman::TreeBuilder::Build() const
@@ -19,7 +72,7 @@ Huffman::Tree Huffman::TreeBuilder::Build() const
 
     std::priority_queue<std::reference_wrapper<Tree::Node>> data;
 
-    for (const auto& item : mFrequencies)
+    for (const auto& item : Reduce())
     {
         const auto& symbol = item.first;
         const auto& value = item.second;
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
+#include <deque>
+#include <mutex>
 #include <ostream>
 #include <unordered_map>
-#include <deque>
 
 #include "Interfaces.hpp"
 #include "Model.hpp"
@@ -12,6 +14,8 @@ namespace Huffman
     using Model::TSymbol;
     using Model::SymbolCode;
 
+    using THistogram = std::array<size_t, 256>;
+
     static constexpr TSymbol NoSymbol{};
     static constexpr int NullNode = -1;
 
@@ -81,12 +85,26 @@ namespace Huffman
     {
     public:
         void Process(const std::vector<TSymbol>& aData);
+        void Process(const TSymbol* aData, size_t aSize);
+
+        // Count each symbol once more, so every symbol gets a code.
+        void Smooth();
+
+        // Private histogram for one thread, reduced on Build().
+        // Reference stays valid while builder lives.
+        THistogram& Partial();
+
+        THistogram Histogram() const;
         Tree Build() const;
 
     private:
         void CalculateSymbolCodes(Tree& aTree, Tree::Node::TNodeIndex aNodeIndex, int aCode, int aLength) const;
+        std::unordered_map<TSymbol, size_t> Reduce() const;
 
     private:
-        std::unordered_map<TSymbol, size_t> mFrequencies;
+        THistogram mFrequencies{};
+
+        std::mutex mPartialsMutex;
+        std::deque<THistogram> mPartials;
     };
 }
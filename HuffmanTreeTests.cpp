@@ -62,3 +62,22 @@ TEST(HuffmanTree, ShouldCalculateCodesWithRespectToSymbolFrequency)
     EXPECT_EQ(2, tree.Codes['C'].Length);
 }
 
+TEST(HuffmanTree, ShouldReducePartialHistograms)
+{
+    Huffman::TreeBuilder builder;
+    builder.Process(MakeBuffer("AB"));
+
+    auto& first = builder.Partial();
+    auto& second = builder.Partial();
+    first['A'] += 2;
+    second['C'] += 1;
+
+    auto histogram = builder.Histogram();
+    EXPECT_EQ(3u, histogram['A']);
+    EXPECT_EQ(1u, histogram['B']);
+    EXPECT_EQ(1u, histogram['C']);
+
+    auto tree = builder.Build();
+    ASSERT_EQ(3u, tree.Codes.size());
+    EXPECT_EQ(1, tree.Codes['A'].Length);
+}
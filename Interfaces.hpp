@@ -18,6 +18,11 @@ struct IStorage
         virtual bool ReadTo(TBuffer* const) = 0;
         virtual size_t Read(char*, const size_t) = 0;
         virtual void Reset() = 0;
+
+        // Random access, doesn't move sequential reading position
+        // and may be called from several threads at once.
+        virtual size_t ReadAt(const size_t aOffset, char*, const size_t) = 0;
+        virtual size_t Size() = 0;
     };
 
     struct Output : InterfaceBase
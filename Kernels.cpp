@@ -0,0 +1,110 @@
+#include "Kernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace Kernels
+{
+    // Four tables break dependency chains on runs of the same symbol.
+    // Data is counted in blocks, so 32-bit counters never overflow.
+    void Histogram(const uint8_t* aData, size_t aSize, size_t* aCounts)
+    {
+        static constexpr size_t BlockSize = size_t{1} << 30;
+
+        for (size_t begin = 0; begin < aSize; begin += BlockSize)
+        {
+            const auto data = aData + begin;
+            const auto size = aSize - begin < BlockSize ? aSize - begin : BlockSize;
+
+            uint32_t counts[4][256]{};
+
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4)
+            {
+                counts[0][data[i + 0]]++;
+                counts[1][data[i + 1]]++;
+                counts[2][data[i + 2]]++;
+                counts[3][data[i + 3]]++;
+            }
+
+            for (; i < size; ++i)
+            {
+                counts[0][data[i]]++;
+            }
+
+            for (size_t symbol = 0; symbol < 256; ++symbol)
+            {
+                aCounts[symbol] += size_t{counts[0][symbol]} + counts[1][symbol] + counts[2][symbol] + counts[3][symbol];
+            }
+        }
+    }
+
+    namespace
+    {
+        void Gather(const uint8_t* aData, size_t aSize, const uint32_t* aValues, const uint32_t* aLengths,
+                    uint32_t* aCodeValues, uint32_t* aCodeLengths)
+        {
+            for (size_t i = 0; i < aSize; ++i)
+            {
+                aCodeValues[i] = aValues[aData[i]];
+                aCodeLengths[i] = aLengths[aData[i]];
+            }
+        }
+
+#ifdef KERNELS_X86_DISPATCH
+        __attribute__((target("avx2"))) void GatherAvx2(const uint8_t* aData, size_t aSize, const uint32_t* aValues,
+                                                        const uint32_t* aLengths, uint32_t* aCodeValues,
+                                                        uint32_t* aCodeLengths)
+        {
+            const auto values = reinterpret_cast<const int*>(aValues);
+            const auto lengths = reinterpret_cast<const int*>(aLengths);
+
+            size_t i = 0;
+            for (; i + 8 <= aSize; i += 8)
+            {
+                auto symbols = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(aData + i));
+                auto indices = _mm256_cvtepu8_epi32(symbols);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(aCodeValues + i), _mm256_i32gather_epi32(values, indices, 4));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(aCodeLengths + i), _mm256_i32gather_epi32(lengths, indices, 4));
+            }
+
+            Gather(aData + i, aSize - i, aValues, aLengths, aCodeValues + i, aCodeLengths + i);
+        }
+
+        const Set Avx2Set{"avx2", GatherAvx2};
+#endif
+
+        const Set PortableSet{"portable", Gather};
+
+        const Set& Select()
+        {
+            auto avx2 = Avx2();
+            return avx2 ? *avx2 : PortableSet;
+        }
+    }
+
+    const Set& Active()
+    {
+        static const Set& active = Select();
+        return active;
+    }
+
+    const Set& Portable()
+    {
+        return PortableSet;
+    }
+
+    const Set* Avx2()
+    {
+#ifdef KERNELS_X86_DISPATCH
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return &Avx2Set;
+        }
+#endif
+        return nullptr;
+    }
+}
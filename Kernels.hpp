@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kernels
+{
+    // Code values and lengths laid out for Gather().
+    struct CodeTable
+    {
+        uint32_t Values[256]{};
+        uint32_t Lengths[256]{};
+
+        void Put(uint8_t aSymbol, uint32_t aValue, unsigned aLength)
+        {
+            Values[aSymbol] = aLength < 32 ? aValue & ((1u << aLength) - 1) : aValue;
+            Lengths[aSymbol] = aLength;
+        }
+    };
+
+    // Adds symbol counts of given data to 256 counters. Vectors give
+    // it nothing, so it has only portable form.
+    void Histogram(const uint8_t* aData, size_t aSize, size_t* aCounts);
+
+    // Hot loops, implemented for several instruction sets.
+    // The best set for current CPU is selected once at startup.
+    struct Set
+    {
+        const char* Name;
+
+        // Looks up code value and length of each given symbol.
+        void (*Gather)(const uint8_t* aData, size_t aSize, const uint32_t* aValues, const uint32_t* aLengths,
+                       uint32_t* aCodeValues, uint32_t* aCodeLengths);
+    };
+
+    const Set& Active();
+
+    // Portable C++ is always available, others are nullptr
+    // if not supported by compiler or CPU.
+    const Set& Portable();
+    const Set* Avx2();
+}
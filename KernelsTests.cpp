@@ -0,0 +1,138 @@
+#include <numeric>
+
+#include "BitsWriter.hpp"
+#include "Kernels.hpp"
+#include "Memory.hpp"
+#include "TestsBase.hpp"
+
+using Helpers::bits_of;
+
+std::vector<uint8_t> MakeData(size_t aSize)
+{
+    std::vector<uint8_t> data(aSize);
+    for (size_t i = 0; i < aSize; ++i)
+    {
+        data[i] = static_cast<uint8_t>(i * 7 % 251 + i / 1000);
+    }
+    return data;
+}
+
+std::vector<const Kernels::Set*> AvailableSets()
+{
+    std::vector<const Kernels::Set*> sets{&Kernels::Portable()};
+    if (Kernels::Avx2())
+    {
+        sets.push_back(Kernels::Avx2());
+    }
+    return sets;
+}
+
+TEST(Kernels, ShouldCountSymbols)
+{
+    auto data = MakeData(10007);
+
+    size_t expected[256]{};
+    for (const auto& c : data)
+    {
+        expected[c]++;
+    }
+
+    size_t counts[256]{};
+    counts['A'] = 1;
+    Kernels::Histogram(data.data(), data.size(), counts);
+
+    counts['A'] -= 1;
+    EXPECT_TRUE(std::equal(std::begin(expected), std::end(expected), std::begin(counts)));
+}
+
+TEST(Kernels, ShouldGatherCodes)
+{
+    auto data = MakeData(1003);
+
+    Kernels::CodeTable codes;
+    for (unsigned symbol = 0; symbol < 256; ++symbol)
+    {
+        codes.Put(static_cast<uint8_t>(symbol), symbol * 3, symbol % 13 + 1);
+    }
+
+    for (auto set : AvailableSets())
+    {
+        std::vector<uint32_t> values(data.size());
+        std::vector<uint32_t> lengths(data.size());
+        set->Gather(data.data(), data.size(), codes.Values, codes.Lengths, values.data(), lengths.data());
+
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            ASSERT_EQ(codes.Values[data[i]], values[i]) << set->Name;
+            ASSERT_EQ(codes.Lengths[data[i]], lengths[i]) << set->Name;
+        }
+    }
+}
+
+TEST(Kernels, ShouldMaskCodeValues)
+{
+    Kernels::CodeTable codes;
+    codes.Put('A', 0xFF, 3);
+    codes.Put('B', 0xFFFFFFFF, 32);
+
+    EXPECT_EQ(0b111u, codes.Values['A']);
+    EXPECT_EQ(0xFFFFFFFFu, codes.Values['B']);
+}
+
+TEST(BitsWriter, ShouldPackCodes)
+{
+    Memory::Writer output;
+    Helpers::BitsWriter bits(output, 4);
+
+    bits.Write(0b011011100101110111, 18);
+    bits.Write(0b001100110011, 12);
+    bits.Write(0b0101, 4);
+    bits.Write(0b11111111111111111111111111111111, 32);
+    bits.Flush();
+
+    EXPECT_EQ(9u, bits.BytesWritten());
+    ASSERT_EQ(9u, output.Data().size());
+
+    EXPECT_EQ("01101110", bits_of(output.Data()[0]));
+    EXPECT_EQ("01011101", bits_of(output.Data()[1]));
+    EXPECT_EQ("11001100", bits_of(output.Data()[2]));
+    EXPECT_EQ("11001101", bits_of(output.Data()[3]));
+    EXPECT_EQ("01111111", bits_of(output.Data()[4]));
+    EXPECT_EQ("11000000", bits_of(output.Data()[8]));
+}
+
+TEST(BitsWriter, ShouldPackPairsAsSingleCodes)
+{
+    // Some pairs are too long to join.
+    Kernels::CodeTable codes;
+    for (unsigned symbol = 0; symbol < 256; ++symbol)
+    {
+        auto length = 1 + symbol % 16;
+        codes.Put(static_cast<uint8_t>(symbol), symbol * 2654435761u, length);
+    }
+
+    const Helpers::PairCodes pairs{codes};
+    EXPECT_EQ(uint32_t{Helpers::PairCodes::Split}, pairs.Pair(15 << 8 | 15) >> 24);
+    EXPECT_EQ(2u, pairs.Pair(0) >> 24);
+
+    // Odd size leaves the last symbol to its own code.
+    const auto data = MakeData(10001);
+
+    Memory::Writer singles;
+    Memory::Writer joint;
+    {
+        Helpers::BitsWriter bits(singles, 64);
+        bits.Encode(data.data(), data.size(), codes);
+        bits.Flush();
+    }
+    {
+        Helpers::BitsWriter bits(joint, 64);
+        bits.Encode(data.data(), data.size(), pairs);
+        bits.Flush();
+    }
+
+    EXPECT_EQ(singles.Data(), joint.Data());
+
+    EXPECT_FALSE(Helpers::PairCodes::Pays(Helpers::PairCodes::MinSize - 1));
+    EXPECT_TRUE(Helpers::PairCodes::Pays(Helpers::PairCodes::MinSize));
+}
@@ -0,0 +1,257 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "Lz.hpp"
+
+namespace Lz
+{
+    namespace
+    {
+        constexpr unsigned HashBits = 15;
+
+        uint32_t Load(const uint8_t* aData)
+        {
+            uint32_t value;
+            std::memcpy(&value, aData, sizeof(value));
+            return value;
+        }
+
+        size_t Hash(const uint8_t* aData)
+        {
+            return (Load(aData) * 2654435761u) >> (32 - HashBits);
+        }
+
+        // Compares by words first, then by bytes.
+        size_t Length(const uint8_t* aFirst, const uint8_t* aSecond, size_t aLimit)
+        {
+            size_t length = 0;
+            while (length + 8 <= aLimit)
+            {
+                uint64_t first;
+                uint64_t second;
+                std::memcpy(&first, aFirst + length, sizeof(first));
+                std::memcpy(&second, aSecond + length, sizeof(second));
+
+                if (first != second)
+                {
+                    break;
+                }
+                length += 8;
+            }
+
+            while (length < aLimit && aFirst[length] == aSecond[length])
+            {
+                ++length;
+            }
+            return length;
+        }
+
+        void PutCount(TBytes& aPart, size_t aCount)
+        {
+            while (aCount >= 255)
+            {
+                aPart.push_back(255);
+                aCount -= 255;
+            }
+            aPart.push_back(static_cast<uint8_t>(aCount));
+        }
+
+        // Reads count of the part, returns false at its end.
+        bool GetCount(const TBytes& aPart, size_t& aPosition, size_t& aCount)
+        {
+            aCount = 0;
+            for (;;)
+            {
+                if (aPosition == aPart.size())
+                {
+                    return false;
+                }
+
+                auto value = aPart[aPosition++];
+                aCount += value;
+
+                if (value != 255)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    void Parse(const uint8_t* aData, size_t aSize, const Options& aOptions, Sequences& aSequences)
+    {
+        if (!aOptions.Valid())
+        {
+            throw std::invalid_argument("Lz: Invalid options.");
+        }
+
+        for (auto& part : aSequences.Parts)
+        {
+            part.clear();
+        }
+
+        auto& runs = aSequences.Parts[Sequences::Runs];
+        auto& literals = aSequences.Parts[Sequences::Literals];
+        auto& lengths = aSequences.Parts[Sequences::Lengths];
+
+        // Chain of each position goes to the previous one of the same hash.
+        const auto mask = aOptions.Window - 1;
+        std::vector<int64_t> heads(size_t{1} << HashBits, -1);
+        std::vector<int64_t> chains(aOptions.Window, -1);
+
+        auto insert = [&](size_t aPosition) {
+            auto& head = heads[Hash(aData + aPosition)];
+            chains[aPosition & mask] = head;
+            head = static_cast<int64_t>(aPosition);
+        };
+
+        size_t anchor = 0;
+        size_t position = 0;
+
+        while (position + MinMatch <= aSize)
+        {
+            size_t best = 0;
+            size_t distance = 0;
+
+            const auto limit = aSize - position;
+
+            auto candidate = heads[Hash(aData + position)];
+            for (unsigned depth = aOptions.Depth; depth && candidate >= 0; --depth)
+            {
+                auto from = static_cast<size_t>(candidate);
+                if (position - from > aOptions.Window)
+                {
+                    break;
+                }
+
+                // Byte past the best match has to match first.
+                if (aData[from + best] == aData[position + best] || best == 0)
+                {
+                    auto length = Length(aData + from, aData + position, limit);
+                    if (length > best)
+                    {
+                        best = length;
+                        distance = position - from;
+
+                        if (best == limit)
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                // Slot may hold a newer position of another chain already.
+                auto next = chains[from & mask];
+                if (next >= candidate)
+                {
+                    break;
+                }
+                candidate = next;
+            }
+
+            insert(position);
+
+            if (best < MinMatch)
+            {
+                ++position;
+                continue;
+            }
+
+            PutCount(runs, position - anchor);
+            literals.insert(literals.end(), aData + anchor, aData + position);
+
+            PutCount(lengths, best - MinMatch);
+            aSequences.Parts[Sequences::High].push_back(static_cast<uint8_t>((distance - 1) >> 8));
+            aSequences.Parts[Sequences::Low].push_back(static_cast<uint8_t>(distance - 1));
+
+            for (auto end = position + best; ++position < end;)
+            {
+                if (position + MinMatch <= aSize)
+                {
+                    insert(position);
+                }
+            }
+
+            anchor = position;
+        }
+
+        PutCount(runs, aSize - anchor);
+        literals.insert(literals.end(), aData + anchor, aData + aSize);
+    }
+
+    bool Unfold(const Sequences& aSequences, uint8_t* aOutput, size_t aSize)
+    {
+        const auto& runs = aSequences.Parts[Sequences::Runs];
+        const auto& literals = aSequences.Parts[Sequences::Literals];
+        const auto& lengths = aSequences.Parts[Sequences::Lengths];
+        const auto& high = aSequences.Parts[Sequences::High];
+        const auto& low = aSequences.Parts[Sequences::Low];
+
+        if (high.size() != low.size())
+        {
+            return false;
+        }
+
+        size_t run = 0;
+        size_t literal = 0;
+        size_t length = 0;
+        size_t match = 0;
+
+        size_t produced = 0;
+        for (;;)
+        {
+            size_t count;
+            if (!GetCount(runs, run, count) || count > literals.size() - literal || count > aSize - produced)
+            {
+                return false;
+            }
+
+            std::memcpy(aOutput + produced, literals.data() + literal, count);
+            literal += count;
+            produced += count;
+
+            if (produced == aSize)
+            {
+                break;
+            }
+
+            if (!GetCount(lengths, length, count) || match == high.size())
+            {
+                return false;
+            }
+
+            count += MinMatch;
+            auto distance = (size_t{high[match]} << 8 | low[match]) + 1;
+            ++match;
+
+            if (distance > produced || count > aSize - produced)
+            {
+                return false;
+            }
+
+            // Far enough matches are copied by words, which may
+            // overlap the match itself and write past its end.
+            auto to = aOutput + produced;
+            auto from = to - distance;
+
+            if (distance >= 8)
+            {
+                for (size_t i = 0; i < count; i += 8)
+                {
+                    std::memcpy(to + i, from + i, 8);
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    to[i] = from[i];
+                }
+            }
+
+            produced += count;
+        }
+
+        return run == runs.size() && literal == literals.size() && length == lengths.size() && match == high.size();
+    }
+}
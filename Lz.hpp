@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Lz
+{
+    using TBytes = std::vector<uint8_t>;
+
+    // Matches are 4 bytes at least and as far back as 64 KiB at most.
+    static constexpr size_t MinMatch = 4;
+    static constexpr size_t MaxWindow = 64 * 1024;
+
+    // Unfold() may write this many bytes past the end of output.
+    static constexpr size_t Slack = 16;
+
+    struct Options
+    {
+        // Positions tried per match and how far back they may be.
+        unsigned Depth{16};
+        size_t Window{MaxWindow};
+
+        // Window is a power of two up to MaxWindow.
+        bool Valid() const
+        {
+            return Depth && Window && Window <= MaxWindow && !(Window & (Window - 1));
+        }
+    };
+
+    // Data as sequences of literals run and match, which are split into
+    // parts of similar values, so each part is coded with its own table.
+    // Counts take a byte, or 255 and the rest of count after it. Distance
+    // less one takes two bytes, high one in High and low one in Low part.
+    struct Sequences
+    {
+        enum Part
+        {
+            Runs,
+            Literals,
+            Lengths,
+            High,
+            Low,
+            Count
+        };
+
+        TBytes Parts[Count];
+    };
+
+    // Greedy parse with hash chains. The last sequence has no match.
+    void Parse(const uint8_t* aData, size_t aSize, const Options& aOptions, Sequences& aSequences);
+
+    // Output takes aSize + Slack bytes. Returns false if sequences
+    // don't make exactly aSize bytes or refer out of output.
+    bool Unfold(const Sequences& aSequences, uint8_t* aOutput, size_t aSize);
+}
@@ -0,0 +1,108 @@
+#include <random>
+
+#include "Lz.hpp"
+#include "TestsBase.hpp"
+
+namespace
+{
+    Lz::TBytes Bytes(const std::string& aText)
+    {
+        return Lz::TBytes(aText.begin(), aText.end());
+    }
+
+    Lz::TBytes RoundTrip(const Lz::TBytes& aData, const Lz::Options& aOptions = Lz::Options{})
+    {
+        Lz::Sequences sequences;
+        Lz::Parse(aData.data(), aData.size(), aOptions, sequences);
+
+        Lz::TBytes output(aData.size() + Lz::Slack);
+        EXPECT_TRUE(Lz::Unfold(sequences, output.data(), aData.size()));
+
+        output.resize(aData.size());
+        return output;
+    }
+}
+
+TEST(Lz, ShouldParseRepeatsAsMatches)
+{
+    auto data = Bytes("abcdabcdabcd");
+
+    Lz::Sequences sequences;
+    Lz::Parse(data.data(), data.size(), Lz::Options{}, sequences);
+
+    // Literals, then match of 8 bytes at distance 4, then empty run.
+    EXPECT_EQ(Bytes(std::string("\x04\x00", 2)), sequences.Parts[Lz::Sequences::Runs]);
+    EXPECT_EQ(Bytes("abcd"), sequences.Parts[Lz::Sequences::Literals]);
+    EXPECT_EQ(Lz::TBytes{4}, sequences.Parts[Lz::Sequences::Lengths]);
+    EXPECT_EQ(Lz::TBytes{0}, sequences.Parts[Lz::Sequences::High]);
+    EXPECT_EQ(Lz::TBytes{3}, sequences.Parts[Lz::Sequences::Low]);
+}
+
+TEST(Lz, ShouldUnfoldParsedData)
+{
+    std::mt19937 random{7};
+
+    EXPECT_EQ(Lz::TBytes{}, RoundTrip(Lz::TBytes{}));
+    EXPECT_EQ(Bytes("abc"), RoundTrip(Bytes("abc")));
+
+    // Long overlapping match takes escaped length.
+    auto run = Bytes(std::string(1000, 'a') + "b");
+    EXPECT_EQ(run, RoundTrip(run));
+
+    for (int i = 0; i < 50; ++i)
+    {
+        Lz::TBytes data(random() % 20000);
+        auto alphabet = 1 + random() % 8;
+        for (auto& byte : data)
+        {
+            byte = static_cast<uint8_t>('a' + random() % alphabet);
+        }
+
+        Lz::Options options;
+        options.Depth = 1 + random() % 32;
+        options.Window = size_t{1} << (8 + random() % 9);
+
+        ASSERT_EQ(data, RoundTrip(data, options));
+    }
+}
+
+TEST(Lz, ShouldKeepMatchesInWindow)
+{
+    std::mt19937 random{3};
+
+    Lz::TBytes data(2000);
+    for (auto& byte : data)
+    {
+        byte = static_cast<uint8_t>(random());
+    }
+    data.insert(data.end(), data.begin(), data.end());
+
+    Lz::Sequences sequences;
+    Lz::Parse(data.data(), data.size(), Lz::Options{}, sequences);
+    EXPECT_EQ(1u, sequences.Parts[Lz::Sequences::High].size());
+
+    Lz::Options options;
+    options.Window = 1024;
+
+    Lz::Parse(data.data(), data.size(), options, sequences);
+    EXPECT_EQ(data.size(), sequences.Parts[Lz::Sequences::Literals].size());
+
+    options.Window = 1000;
+    EXPECT_THROW(Lz::Parse(data.data(), data.size(), options, sequences), std::invalid_argument);
+}
+
+TEST(Lz, ShouldRejectInvalidSequences)
+{
+    auto data = Bytes("abcdabcdabcd");
+
+    Lz::Sequences sequences;
+    Lz::Parse(data.data(), data.size(), Lz::Options{}, sequences);
+
+    Lz::TBytes output(data.size() + Lz::Slack);
+    EXPECT_FALSE(Lz::Unfold(sequences, output.data(), data.size() - 1));
+    EXPECT_FALSE(Lz::Unfold(sequences, output.data(), data.size() + 1));
+
+    // Match refers before the start of data.
+    sequences.Parts[Lz::Sequences::Low][0] = 4;
+    EXPECT_FALSE(Lz::Unfold(sequences, output.data(), data.size()));
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstring>
+
+#include "Memory.hpp"
+
+namespace Memory
+{
+    static constexpr size_t BufferSize = 4096;
+
+    Reader::Reader(const char* aData, size_t aSize)
+      : mData{aData}
+      , mSize{aSize}
+    {
+    }
+
+    Reader::Reader(const std::string& aData)
+      : Reader{aData.data(), aData.size()}
+    {
+    }
+
+    bool Reader::ReadTo(TBuffer* aBuffer)
+    {
+        auto count = std::min(BufferSize, mSize - mPosition);
+
+        aBuffer->assign(mData + mPosition, mData + mPosition + count);
+        mPosition += count;
+
+        return count != 0;
+    }
+
+    size_t Reader::Read(char* aBuffer, size_t aSize)
+    {
+        auto count = std::min(aSize, mSize - mPosition);
+
+        std::memcpy(aBuffer, mData + mPosition, count);
+        mPosition += count;
+
+        return count;
+    }
+
+    void Reader::Reset()
+    {
+        mPosition = 0;
+    }
+
+    size_t Reader::ReadAt(size_t aOffset, char* aBuffer, size_t aSize)
+    {
+        auto offset = std::min(aOffset, mSize);
+        auto count = std::min(aSize, mSize - offset);
+
+        std::memcpy(aBuffer, mData + offset, count);
+        return count;
+    }
+
+    size_t Reader::Size()
+    {
+        return mSize;
+    }
+
+    void Writer::Write(const char* aBuffer, size_t aSize)
+    {
+        if (mData.size() < mPosition + aSize)
+        {
+            mData.resize(mPosition + aSize);
+        }
+
+        mData.replace(mPosition, aSize, aBuffer, aSize);
+        mPosition += aSize;
+    }
+
+    void Writer::Skip(const size_t aSize)
+    {
+        mPosition += aSize;
+
+        if (mData.size() < mPosition)
+        {
+            mData.resize(mPosition);
+        }
+    }
+
+    void Writer::Reset()
+    {
+        mPosition = 0;
+    }
+
+    const std::string& Writer::Data() const
+    {
+        return mData;
+    }
+
+    void Writer::Clear()
+    {
+        mData.clear();
+        mPosition = 0;
+    }
+
+    void Writer::Reserve(size_t aSize)
+    {
+        mData.reserve(aSize);
+    }
+}
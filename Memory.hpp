@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+
+#include "Interfaces.hpp"
+
+namespace Memory
+{
+    struct Reader final : IStorage::Input
+    {
+        Reader(const char* aData, size_t aSize);
+        Reader(const std::string& aData);
+
+        virtual bool ReadTo(TBuffer* aBuffer) override;
+        virtual size_t Read(char* aBuffer, size_t aSize) override;
+        virtual void Reset() override;
+        virtual size_t ReadAt(size_t aOffset, char* aBuffer, size_t aSize) override;
+        virtual size_t Size() override;
+
+    private:
+        const char* mData{nullptr};
+        size_t mSize{0};
+        size_t mPosition{0};
+    };
+
+    struct Writer final : IStorage::Output
+    {
+        virtual void Write(const char* aBuffer, size_t aSize) override;
+        virtual void Skip(const size_t aSize) override;
+        virtual void Reset() override;
+
+        const std::string& Data() const;
+
+        // Drops written data, but keeps memory for further writes.
+        void Clear();
+        void Reserve(size_t aSize);
+
+    private:
+        std::string mData;
+        size_t mPosition{0};
+    };
+}
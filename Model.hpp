@@ -32,4 +32,136 @@ namespace Model
         size_t FileSize;
         SymbolsTable Table;
     };
+
+    // Header of a file encoded with a preloaded shared table.
+    struct SharedFileHeader
+    {
+        static constexpr uint32_t Signature = 0x4D485348; // "HSHM"
+
+        uint32_t Magic;
+        uint32_t TableId;
+        size_t FileSize;
+    };
+
+    struct TableFileHeader
+    {
+        static constexpr uint32_t Signature = 0x4C425448; // "HTBL"
+
+        uint32_t Magic;
+        uint32_t Id;
+        FileHeader::SymbolsTable Table;
+    };
+
+    // Batch container layout: header with symbols table,
+    // then records index, then byte aligned encoded records.
+    struct BatchHeader
+    {
+        static constexpr uint32_t Signature = 0x48544142; // "BATH"
+
+        struct Record
+        {
+            uint32_t Offset;
+            uint32_t Size;
+        };
+
+        uint32_t Magic;
+        uint32_t Count;
+        FileHeader::SymbolsTable Table;
+    };
+
+    // Archive layout: header with optional shared symbols table, then byte
+    // aligned members, then index of members at IndexOffset. Without shared
+    // table each member starts with its own FileHeader::SymbolsTable.
+    struct ArchiveHeader
+    {
+        static constexpr uint32_t Signature = 0x56524148; // "HARV"
+
+        // Index record, followed by name of NameLength bytes.
+        struct Member
+        {
+            uint64_t Offset;
+            uint64_t EncodedSize;
+            uint64_t Size;
+            uint32_t NameLength;
+            uint32_t Reserved;
+        };
+
+        uint32_t Magic;
+        uint32_t Count;
+        uint64_t IndexOffset;
+        FileHeader::SymbolsTable Table;
+    };
+
+    // Stream layout: header, then byte aligned blocks, each of them may be
+    // decoded as soon as it is received. Empty block ends the stream.
+    struct StreamHeader
+    {
+        static constexpr uint32_t Signature = 0x52545348; // "HSTR"
+
+        uint32_t Magic;
+        uint32_t BlockSize;
+    };
+
+    // Block header is followed by TableLength pairs of symbol and code
+    // length, canonical codes are restored from them, then by encoded data.
+    // EncodedSize counts everything after the header. Transformed block
+    // has Transformed record between table and data, data decodes to
+    // Length bytes, which are turned back into Size ones. Lz block has
+    // no table, its data is a nested block of each part of Lz::Sequences,
+    // stored or coded with its own table, but never transformed. Ans block
+    // has TableLength weights of symbols instead of entries, then Final
+    // record, then bits of the coders. Repeat block is coded as Huffman one
+    // with the table of the last block of stream, which has a table
+    // (Huffman mode, transformed or not), so it has none of its own.
+    struct BlockHeader
+    {
+        enum Modes : uint8_t
+        {
+            Huffman = 0,
+            Stored = 1,
+            Lz = 2,
+            Ans = 3,
+            Repeat = 4
+        };
+
+        enum Transforms : uint8_t
+        {
+            None = 0,
+            Bwt = 1
+        };
+
+        struct Entry
+        {
+            TSymbol Symbol;
+            uint8_t Length;
+        };
+
+        // Normalized count of symbol, counts add up to 1 << TableLog.
+        struct Weight
+        {
+            TSymbol Symbol;
+            uint8_t Reserved;
+            uint16_t Count;
+        };
+
+        struct Final
+        {
+            uint16_t States[2];
+            uint8_t TableLog;
+            uint8_t Padding;
+            uint16_t Reserved;
+        };
+
+        struct Transformed
+        {
+            uint32_t Primary;
+            uint32_t Length;
+        };
+
+        uint32_t Size;
+        uint32_t EncodedSize;
+        uint16_t TableLength;
+        uint8_t Mode;
+        uint8_t Transform;
+    };
 }
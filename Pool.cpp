@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include "Pool.hpp"
+
+namespace Pool
+{
+    WorkStealing::WorkStealing(unsigned aThreads)
+      : mThreads{aThreads}
+    {
+        if (aThreads == 0)
+        {
+            throw std::invalid_argument("Pool: Invalid number of threads.");
+        }
+    }
+
+    unsigned WorkStealing::Threads() const
+    {
+        return mThreads;
+    }
+
+    bool WorkStealing::Take(size_t aIndex, TJob& aJob)
+    {
+        auto& queue = mQueues[aIndex];
+
+        std::lock_guard<std::mutex> lock{queue.Mutex};
+        if (queue.Jobs.empty())
+        {
+            return false;
+        }
+
+        aJob = std::move(queue.Jobs.front());
+        queue.Jobs.pop_front();
+        return true;
+    }
+
+    bool WorkStealing::Steal(size_t aIndex, TJob& aJob)
+    {
+        for (size_t i = 1; i < mQueues.size(); ++i)
+        {
+            auto& queue = mQueues[(aIndex + i) % mQueues.size()];
+
+            std::lock_guard<std::mutex> lock{queue.Mutex};
+            if (!queue.Jobs.empty())
+            {
+                aJob = std::move(queue.Jobs.back());
+                queue.Jobs.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void WorkStealing::Run(std::vector<TJob> aJobs)
+    {
+        auto threads = std::min<size_t>(mThreads, aJobs.size());
+        if (threads == 0)
+        {
+            return;
+        }
+
+        mQueues = std::vector<Queue>(threads);
+        for (size_t i = 0; i < aJobs.size(); ++i)
+        {
+            mQueues[i % threads].Jobs.push_back(std::move(aJobs[i]));
+        }
+
+        std::mutex errorMutex;
+        std::exception_ptr error;
+
+        auto worker = [&](size_t aIndex) {
+            TJob job;
+            while (Take(aIndex, job) || Steal(aIndex, job))
+            {
+                try
+                {
+                    job();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock{errorMutex};
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        // Calling thread is one of workers.
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < threads; ++i)
+        {
+            workers.emplace_back(worker, i);
+        }
+
+        worker(0);
+
+        for (auto& thread : workers)
+        {
+            thread.join();
+        }
+
+        mQueues.clear();
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
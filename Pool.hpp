@@ -0,0 +1,41 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Pool
+{
+    using TJob = std::function<void()>;
+
+    // Runs a set of jobs on several threads. Each thread takes jobs from
+    // the front of its own queue and, when it runs out of them, steals
+    // from the back of others, so no thread idles while work remains.
+    class WorkStealing
+    {
+    public:
+        explicit WorkStealing(unsigned aThreads);
+
+        // Jobs are dealt round-robin in given order, so jobs given first
+        // are started first. Blocks until all jobs are done and rethrows
+        // the first exception, if any.
+        void Run(std::vector<TJob> aJobs);
+
+        unsigned Threads() const;
+
+    private:
+        struct Queue
+        {
+            std::mutex Mutex;
+            std::deque<TJob> Jobs;
+        };
+
+        bool Take(size_t aIndex, TJob& aJob);
+        bool Steal(size_t aIndex, TJob& aJob);
+
+    private:
+        unsigned mThreads;
+        std::vector<Queue> mQueues;
+    };
+}
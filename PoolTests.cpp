@@ -0,0 +1,77 @@
+#include <atomic>
+#include <thread>
+
+#include "Pool.hpp"
+#include "TestsBase.hpp"
+
+TEST(Pool, ShouldRunEachJobOnce)
+{
+    std::vector<std::atomic<int>> runs(100);
+    for (auto& run : runs)
+    {
+        run = 0;
+    }
+
+    std::vector<Pool::TJob> jobs;
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        jobs.push_back([&runs, i]() { runs[i]++; });
+    }
+
+    Pool::WorkStealing{4}.Run(std::move(jobs));
+
+    for (const auto& run : runs)
+    {
+        EXPECT_EQ(1, run);
+    }
+}
+
+TEST(Pool, ShouldStealJobsOfBusyThread)
+{
+    std::atomic<bool> release{false};
+    std::atomic<int> done{0};
+
+    // First job blocks its thread until all others are done,
+    // so jobs queued behind it have to be stolen.
+    std::vector<Pool::TJob> jobs;
+    jobs.push_back([&]() {
+        while (!release)
+        {
+            std::this_thread::yield();
+        }
+    });
+
+    for (int i = 0; i < 10; ++i)
+    {
+        jobs.push_back([&]() {
+            if (++done == 10)
+            {
+                release = true;
+            }
+        });
+    }
+
+    Pool::WorkStealing{2}.Run(std::move(jobs));
+
+    EXPECT_EQ(10, done);
+}
+
+TEST(Pool, ShouldRethrowExceptionAfterAllJobs)
+{
+    std::atomic<int> done{0};
+
+    std::vector<Pool::TJob> jobs;
+    jobs.push_back([]() { throw std::runtime_error("failure"); });
+    for (int i = 0; i < 5; ++i)
+    {
+        jobs.push_back([&done]() { done++; });
+    }
+
+    EXPECT_THROW(Pool::WorkStealing{3}.Run(std::move(jobs)), std::runtime_error);
+    EXPECT_EQ(5, done);
+}
+
+TEST(Pool, ShouldThrowIfNoThreads)
+{
+    EXPECT_THROW(Pool::WorkStealing{0}, std::invalid_argument);
+}
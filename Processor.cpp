@@ -1,19 +1,54 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <memory>
+#include <numeric>
 #include <string>
+#include <thread>
 
-#include "BitsAdapter.hpp"
+#include "BitsWriter.hpp"
+#include "DecodeTable.hpp"
+#include "FlatTree.hpp"
 #include "HuffmanTree.hpp"
+#include "Kernels.hpp"
 #include "Processor.hpp"
-#include "SymbolsLookup.hpp"
+#include "SpeculativeDecoder.hpp"
 #include "StreamWriter.hpp"
 
 namespace Processor
 {
     using Model::FileHeader;
+    using Model::SharedFileHeader;
 
     static Config DefaultConfig;
 
+    static constexpr size_t ParallelReadSize = 1024 * 1024;
+
+    static constexpr size_t PairsSize = 256 * 256 * sizeof(uint32_t);
+
+    // Settings are shrunk by Fit() down to these.
+    static constexpr unsigned MinPipelineDepth = 2;
+    static constexpr size_t MinPipelineSize = 64 * 1024;
+    static constexpr size_t MinBlockSize = 64 * 1024;
+    static constexpr unsigned MinPeekBits = 8;
+
+    // Each decoding thread keeps its chunk of data and symbols decoded
+    // from it, which are about as many as in the whole file.
+    size_t DecodingThreadSize()
+    {
+        return 4 * Helpers::SpeculativeDecoder::Options{}.ChunkSize;
+    }
+
+    size_t TableSize(const Config& aConfig)
+    {
+        return (size_t{1} << aConfig.Lookup.PeekBits) * sizeof(Helpers::DecodeTable::Entry);
+    }
+
+    Budget::Lease TakeBuffers(const Config& aConfig, size_t aExtra = 0)
+    {
+        return Budget::Lease{aConfig.Memory, aConfig.Buffer.InputSize + aConfig.Buffer.OutputSize + aExtra};
+    }
+
     void CheckConfig(const Config& aConfig)
     {
         static constexpr auto MinReaderSize = sizeof(FileHeader) + sizeof(FileHeader::SymbolsTable::Entry) * 256;
@@ -29,6 +64,377 @@ namespace Processor
         };
     }
 
+    // Collect symbol frequencies from part of source only.
+    // Returns false if whole source should be scanned instead.
+    bool SampleData(IStorage::Input& aInput, Huffman::TreeBuilder& aBuilder, const Config& aConfig)
+    {
+        const auto& sample = aConfig.Sample;
+        if (sample.Fraction >= 1.0 || sample.ChunkSize == 0)
+        {
+            return false;
+        }
+
+        auto size = aInput.Size();
+        auto chunks = static_cast<size_t>(std::ceil(size * std::max(sample.Fraction, 0.0) / sample.ChunkSize));
+        chunks = std::max<size_t>(chunks, 1);
+
+        if (chunks * sample.ChunkSize >= size)
+        {
+            return false;
+        }
+
+        std::vector<Model::TSymbol> buffer(sample.ChunkSize);
+
+        auto stride = size / chunks;
+        for (size_t i = 0; i < chunks; ++i)
+        {
+            auto count = aInput.ReadAt(i * stride, reinterpret_cast<char*>(buffer.data()), buffer.size());
+            aBuilder.Process(buffer.data(), count);
+        }
+
+        // Symbols missed by sample still need codes.
+        aBuilder.Smooth();
+
+        aInput.Reset();
+        return true;
+    }
+
+    // Each thread counts symbols of its own part of source
+    // into private histogram, reading it at disjoint offsets.
+    // Returns false if source should be scanned sequentially instead.
+    bool ScanDataParallel(IStorage::Input& aInput, Huffman::TreeBuilder& aBuilder, const Config& aConfig)
+    {
+        if (aConfig.Threads < 2)
+        {
+            return false;
+        }
+
+        auto size = aInput.Size();
+        auto threads = std::min<size_t>(aConfig.Threads, size / aConfig.Buffer.InputSize);
+
+        // Only threads, whose buffers fit in budget, are started.
+        const auto bufferSize = std::max(aConfig.Buffer.InputSize, ParallelReadSize);
+        auto buffers = Budget::Lease::Share(aConfig.Memory, bufferSize, threads);
+
+        if (threads < 2)
+        {
+            return false;
+        }
+
+        std::vector<std::exception_ptr> errors(threads);
+        {
+            // Started workers are joined, even if starting the next one throws.
+            struct Workers
+            {
+                ~Workers()
+                {
+                    for (auto& thread : Threads)
+                    {
+                        thread.join();
+                    }
+                }
+
+                std::vector<std::thread> Threads;
+            } workers;
+
+            for (size_t i = 0; i < threads; ++i)
+            {
+                auto begin = size * i / threads;
+                auto end = size * (i + 1) / threads;
+                auto& histogram = aBuilder.Partial();
+                auto& error = errors[i];
+
+                workers.Threads.emplace_back([&aInput, &aConfig, &histogram, &error, begin, end, bufferSize]() {
+                    Trace::Span span{aConfig.Trace, "histogram", "encode"};
+                    try
+                    {
+                        std::vector<Model::TSymbol> buffer(bufferSize);
+
+                        for (auto offset = begin; offset < end;)
+                        {
+                            auto size = std::min(buffer.size(), end - offset);
+                            auto count = aInput.ReadAt(offset, reinterpret_cast<char*>(buffer.data()), size);
+                            if (!count)
+                            {
+                                break;
+                            }
+
+                            Kernels::Histogram(buffer.data(), count, histogram.data());
+
+                            offset += count;
+                        }
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                    }
+                });
+            }
+        }
+
+        for (const auto& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        return true;
+    }
+
+    Kernels::CodeTable Flatten(const Huffman::Tree::TSymbolCodes& aCodes)
+    {
+        Kernels::CodeTable table;
+        for (const auto& p : aCodes)
+        {
+            table.Put(p.first, p.second.Value, p.second.Length);
+        }
+        return table;
+    }
+
+    Kernels::CodeTable Flatten(const Huffman::SharedTable::TCodes& aCodes)
+    {
+        Kernels::CodeTable table;
+        for (size_t symbol = 0; symbol < aCodes.size(); ++symbol)
+        {
+            table.Put(static_cast<Model::TSymbol>(symbol), aCodes[symbol].Value, aCodes[symbol].Length);
+        }
+        return table;
+    }
+
+    // Scan source and encode each symbol with corresponded Huffman code,
+    // or each pair of them if source of aSize is long.
+    // Returns number of symbols encoded.
+    size_t EncodeData(IStorage::Input& aInput, IStorage::Output& aOutput, const Kernels::CodeTable& aCodes,
+                      size_t aSize, const Config& aConfig)
+    {
+        std::vector<unsigned char> buffer;
+        buffer.reserve(aConfig.Buffer.InputSize);
+
+        Helpers::BitsWriter bits(aOutput, aConfig.Buffer.OutputSize);
+
+        Budget::Lease table;
+        std::unique_ptr<Helpers::PairCodes> pairs;
+        if (Helpers::PairCodes::Pays(aSize))
+        {
+            table = Budget::Lease{aConfig.Memory, PairsSize};
+            pairs.reset(new Helpers::PairCodes{aCodes});
+        }
+
+        size_t fileSize = 0;
+        while (aInput.ReadTo(&buffer))
+        {
+            Trace::Span span{aConfig.Trace, "encode", "encode"};
+
+            fileSize += buffer.size();
+            if (pairs)
+            {
+                bits.Encode(buffer.data(), buffer.size(), *pairs);
+            }
+            else
+            {
+                bits.Encode(buffer.data(), buffer.size(), aCodes);
+            }
+        }
+
+        bits.Flush();
+
+        return fileSize;
+    }
+
+    // Scan compressed data, look up symbols by peeked bits
+    // and write them down. Data which is already in source
+    // buffer is processed first.
+    void DecodeData(IStorage::Input& aInput, IStorage::Output& aOutput, const Helpers::DecodeTable& aTable,
+                    size_t aFileSize, char* aSource, size_t aSourceSize, const char* aData, size_t aCount,
+                    const Config& aConfig)
+    {
+        Helpers::SymbolsDecoder decoder{aTable};
+        Helpers::StreamWriter<> stream(aOutput);
+
+        size_t totalSize = 0;
+        auto count = aCount;
+        auto final = false;
+
+        while (totalSize < aFileSize && !final)
+        {
+            if (!count)
+            {
+                count = aInput.Read(aSource, aSourceSize);
+                aData = aSource;
+                final = count == 0;
+            }
+
+            Trace::Span span{aConfig.Trace, "decode", "decode"};
+
+            auto result = decoder.Decode(aData, count, aFileSize - totalSize, final, stream);
+            totalSize += result.Produced;
+            count = 0;
+        }
+
+        stream.Flush();
+    }
+
+    void EncodeShared(IStorage::Input& aInput, IStorage::Output& aOutput, const Config& aConfig)
+    {
+        auto buffers = TakeBuffers(aConfig);
+
+        const auto table = aConfig.Tables->Default();
+        if (!table || !table->IsComplete())
+        {
+            throw std::runtime_error("Encoder: Shared table must have code for each symbol.");
+        }
+
+        // Leave space for header, table is referenced by its id only.
+        aOutput.Skip(sizeof(SharedFileHeader));
+
+        Counters::Scope encoding{aConfig.Profile, "encode"};
+        auto fileSize = EncodeData(aInput, aOutput, Flatten(table->Codes), aInput.Size(), aConfig);
+        encoding.Bytes(fileSize);
+
+        aOutput.Reset();
+
+        SharedFileHeader header;
+        header.Magic = SharedFileHeader::Signature;
+        header.FileSize = fileSize;
+        header.TableId = table->Id;
+        aOutput.Write(reinterpret_cast<char*>(&header), sizeof(SharedFileHeader));
+    }
+
+    void DecodeShared(IStorage::Input& aInput, IStorage::Output& aOutput, const Config& aConfig)
+    {
+        auto buffers = TakeBuffers(aConfig);
+        std::unique_ptr<char[]> source{new char[aConfig.Buffer.InputSize]};
+
+        auto count = aInput.Read(source.get(), aConfig.Buffer.InputSize);
+        if (count < sizeof(SharedFileHeader))
+        {
+            throw std::runtime_error("Decoder: File has no header.");
+        }
+
+        auto header = reinterpret_cast<SharedFileHeader*>(source.get());
+        if (header->Magic != SharedFileHeader::Signature)
+        {
+            throw std::runtime_error("Decoder: Not encoded with shared table.");
+        }
+
+        auto table = aConfig.Tables->Find(header->TableId);
+        if (!table)
+        {
+            throw std::runtime_error("Decoder: Unknown shared table " + std::to_string(header->TableId) + ".");
+        }
+
+        Counters::Scope decoding{aConfig.Profile, "decode"};
+        decoding.Bytes(header->FileSize);
+
+        DecodeData(aInput, aOutput, table->Decoding, header->FileSize, source.get(), aConfig.Buffer.InputSize,
+                   source.get() + sizeof(SharedFileHeader), count - sizeof(SharedFileHeader), aConfig);
+    }
+
+    void EncodeBlocks(IStorage::Input& aInput, IStorage::Output& aOutput, const Config& aConfig)
+    {
+        auto buffers = TakeBuffers(aConfig, Stream::EncoderFootprint(*aConfig.Blocks));
+        Stream::Encoder encoder{aOutput, *aConfig.Blocks};
+
+        std::unique_ptr<char[]> buffer{new char[aConfig.Buffer.InputSize]};
+        while (auto count = aInput.Read(buffer.get(), aConfig.Buffer.InputSize))
+        {
+            Trace::Span span{aConfig.Trace, "encode", "encode"};
+            encoder.Feed(buffer.get(), count);
+        }
+
+        encoder.Finish();
+    }
+
+    void DecodeBlocks(IStorage::Input& aInput, IStorage::Output& aOutput, const Config& aConfig)
+    {
+        auto buffers = TakeBuffers(aConfig);
+        Stream::Decoder decoder{aConfig.Memory};
+
+        std::unique_ptr<char[]> source{new char[aConfig.Buffer.InputSize]};
+        std::unique_ptr<char[]> target{new char[aConfig.Buffer.OutputSize]};
+
+        while (!decoder.Finished())
+        {
+            auto count = aInput.Read(source.get(), aConfig.Buffer.InputSize);
+            if (!count)
+            {
+                throw std::runtime_error("Decoder: Stream is truncated.");
+            }
+
+            Trace::Span span{aConfig.Trace, "decode", "decode"};
+
+            // Output buffer may take less than whole input.
+            for (size_t offset = 0; offset < count && !decoder.Finished();)
+            {
+                auto result = decoder.Feed(source.get() + offset, count - offset, target.get(), aConfig.Buffer.OutputSize);
+                aOutput.Write(target.get(), result.Produced);
+                offset += result.Consumed;
+            }
+        }
+    }
+
+    size_t Footprint(const Config& aConfig, const Uring::Options* aPipeline)
+    {
+        auto size = aConfig.Buffer.InputSize + aConfig.Buffer.OutputSize + std::max(PairsSize, TableSize(aConfig));
+
+        if (aConfig.Blocks)
+        {
+            size += std::max(Stream::EncoderFootprint(*aConfig.Blocks),
+                             Stream::DecoderFootprint(aConfig.Blocks->BlockSize));
+        }
+
+        if (aConfig.Threads > 1)
+        {
+            size += aConfig.Threads *
+                    std::max(std::max(aConfig.Buffer.InputSize, ParallelReadSize), DecodingThreadSize());
+        }
+
+        // Requests of both reader and writer.
+        if (aPipeline)
+        {
+            size += 2 * aPipeline->Depth * aPipeline->BlockSize;
+        }
+
+        return size;
+    }
+
+    void Fit(size_t aBudget, Config& aConfig, Stream::Options* aBlocks, Uring::Options* aPipeline)
+    {
+        auto fits = [&]() { return Footprint(aConfig, aPipeline) <= aBudget; };
+
+        while (!fits() && aConfig.Threads > 1)
+        {
+            --aConfig.Threads;
+        }
+
+        while (!fits() && aPipeline && aPipeline->Depth > MinPipelineDepth)
+        {
+            --aPipeline->Depth;
+        }
+
+        while (!fits() && aPipeline && aPipeline->BlockSize > MinPipelineSize)
+        {
+            aPipeline->BlockSize /= 2;
+        }
+
+        while (!fits() && aBlocks && aBlocks->BlockSize > MinBlockSize)
+        {
+            aBlocks->BlockSize /= 2;
+        }
+
+        while (!fits() && aConfig.Lookup.PeekBits > MinPeekBits)
+        {
+            --aConfig.Lookup.PeekBits;
+        }
+
+        if (!fits())
+        {
+            throw std::runtime_error("Processor: Memory budget is too small.");
+        }
+    }
+
     void Encode(IStorage::Input& aInput, IStorage::Output& aOutput)
     {
         return Encode(aInput, aOutput, DefaultConfig);
@@ -38,19 +444,45 @@ namespace Processor
     {
         CheckConfig(aConfig);
 
+        if (aConfig.Tables)
+        {
+            return EncodeShared(aInput, aOutput, aConfig);
+        }
+
+        if (aConfig.Blocks)
+        {
+            return EncodeBlocks(aInput, aOutput, aConfig);
+        }
+
+        auto buffers = TakeBuffers(aConfig);
+
         std::vector<unsigned char> buffer;
         buffer.reserve(aConfig.Buffer.InputSize);
 
         // Collect information about source file.
         // Then build Huffman tree.
-        size_t fileSize = 0;
         Huffman::TreeBuilder builder;
-        while (aInput.ReadTo(&buffer))
         {
-            fileSize += buffer.size();
-            builder.Process(buffer);
+            Counters::Scope histogram{aConfig.Profile, "histogram"};
+            Trace::Span span{aConfig.Trace, "histogram", "encode"};
+            if (!SampleData(aInput, builder, aConfig) && !ScanDataParallel(aInput, builder, aConfig))
+            {
+                while (aInput.ReadTo(&buffer))
+                {
+                    builder.Process(buffer);
+                }
+            }
+
+            const auto& counts = builder.Histogram();
+            histogram.Bytes(std::accumulate(counts.begin(), counts.end(), size_t{0}));
+        }
+
+        Huffman::Tree tree;
+        {
+            Counters::Scope building{aConfig.Profile, "tree"};
+            Trace::Span span{aConfig.Trace, "tree", "encode"};
+            tree = builder.Build();
         }
-        auto tree = builder.Build();
 
         // Leave space for header.
         aOutput.Skip(sizeof(FileHeader));
@@ -68,29 +500,9 @@ namespace Processor
         // and encode each symbol with corresponded Huffman code.
         aInput.Reset();
 
-        std::unique_ptr<char> encodedStream{new char[aConfig.Buffer.OutputSize]};
-        Helpers::BitsAdapter bits(encodedStream.get(), aConfig.Buffer.OutputSize);
-
-        while (aInput.ReadTo(&buffer))
-        {
-            for (const auto& c : buffer)
-            {
-                const auto& item = tree.Codes[c];
-                bits.Write(item.Value, item.Length);
-
-                if (bits.IsFull())
-                {
-                    aOutput.Write(encodedStream.get(), bits.BytesTaken());
-                    bits.Reset();
-                }
-            }
-        }
-
-        if (bits.BytesTaken())
-        {
-            aOutput.Write(encodedStream.get(), bits.BytesTaken());
-            bits.Reset();
-        }
+        Counters::Scope encoding{aConfig.Profile, "encode"};
+        auto fileSize = EncodeData(aInput, aOutput, Flatten(tree.Codes), aInput.Size(), aConfig);
+        encoding.Bytes(fileSize);
 
         // Finally, we stamp file header and we done.
         aOutput.Reset();
@@ -110,9 +522,21 @@ namespace Processor
     {
         CheckConfig(aConfig);
 
+        if (aConfig.Tables)
+        {
+            return DecodeShared(aInput, aOutput, aConfig);
+        }
+
+        if (aConfig.Blocks)
+        {
+            return DecodeBlocks(aInput, aOutput, aConfig);
+        }
+
+        auto buffers = TakeBuffers(aConfig, TableSize(aConfig));
+
         // We must be sure that given file
         // has correct header and symbols table.
-        std::unique_ptr<char> source{new char[aConfig.Buffer.InputSize]};
+        std::unique_ptr<char[]> source{new char[aConfig.Buffer.InputSize]};
 
         auto count = aInput.Read(source.get(), aConfig.Buffer.InputSize);
         if (count < sizeof(FileHeader))
@@ -130,61 +554,62 @@ namespace Processor
         }
 
         // Build Huffman codes lookup table.
-        Helpers::SymbolsLookup lookup;
-        for (size_t i = 0; i < header->Table.Length; ++i)
+        const auto entries = header->Table.Entries;
+        Helpers::DecodeTable table;
         {
-            lookup.Put(header->Table.Entries[i]);
+            Counters::Scope building{aConfig.Profile, "table"};
+            Trace::Span span{aConfig.Trace, "table", "decode"};
+            table = Helpers::DecodeTable{entries, entries + header->Table.Length, aConfig.Lookup.PeekBits,
+                                         aConfig.Lookup.Symbols};
         }
 
-        // Get compressed data offset.
-        char* data = source.get() + symbolsTableSize;
-        count -= symbolsTableSize;
-
-        // Now, scan compressed data and for each given set of bits we
-        // look for corresponded symbol. If we have one, then write it down.
-        Helpers::CodeProducer producer;
-        Helpers::StreamWriter<> stream(aOutput);
+        Counters::Scope decoding{aConfig.Profile, "decode"};
+        decoding.Bytes(fileSize);
 
-        size_t totalSize = 0;
+        // Large files are split between threads, as many as budget allows.
+        if (aConfig.Threads > 1 && aInput.Size() >= symbolsTableSize + 2 * ParallelReadSize)
+        {
+            size_t threads = aConfig.Threads;
+            auto chunks = Budget::Lease::Share(aConfig.Memory, DecodingThreadSize(), threads);
 
-        auto decoder = [&producer, &lookup, &stream, &totalSize, fileSize](const char* aData, size_t aSize) {
-            for (size_t i = 0; i < aSize; ++i)
+            if (threads > 1)
             {
-                const auto& value = aData[i];
-                producer.Add(value);
+                Helpers::SpeculativeDecoder::Options options;
+                options.Threads = static_cast<unsigned>(threads);
 
-                // Enumerate all possible code from current 'point-of-view'.
-                // And try to find corresponded symbol.
-                while (producer.Next())
-                {
-                    auto find = lookup.Find(producer.Value, producer.Length);
-                    if (find.Success)
-                    {
-                        stream.Write(find.Symbol);
-                        producer.Rewind();
-
-                        totalSize += 1;
-                        if (totalSize == fileSize)
-                        {
-                            return false;
-                        }
-                    }
-                }
+                Helpers::SpeculativeDecoder decoder{entries, entries + header->Table.Length, options};
+                decoder.Decode(aInput, symbolsTableSize, fileSize, aOutput);
+                return;
             }
-            return true;
-        };
+        }
 
-        while (count > 0)
-        {
-            if (!decoder(data, count))
-            {
-                break;
-            }
+        // Get compressed data offset.
+        DecodeData(aInput, aOutput, table, fileSize, source.get(), aConfig.Buffer.InputSize,
+                   source.get() + symbolsTableSize, count - symbolsTableSize, aConfig);
+    }
+
+    void Train(IStorage::Input& aInput, IStorage::Output& aOutput)
+    {
+        return Train(aInput, aOutput, DefaultConfig);
+    }
+
+    void Train(IStorage::Input& aInput, IStorage::Output& aOutput, const Config& aConfig)
+    {
+        auto buffers = TakeBuffers(aConfig);
+        Huffman::TreeBuilder builder;
 
-            count = aInput.Read(source.get(), aConfig.Buffer.InputSize);
-            data = source.get();
+        // Every symbol must have a code, even if corpus has none of it.
+        builder.Smooth();
+
+        std::vector<unsigned char> buffer;
+        buffer.reserve(aConfig.Buffer.InputSize);
+
+        while (aInput.ReadTo(&buffer))
+        {
+            builder.Process(buffer);
         }
 
-        stream.Flush();
+        Huffman::FlatTreeBuilder codes;
+        Huffman::SharedTable::Make(codes.Build(builder.Histogram())).Save(aOutput);
     }
 }
@@ -1,7 +1,14 @@
 #pragma once
 
+#include "Budget.hpp"
+#include "Counters.hpp"
+#include "DecodeTable.hpp"
 #include "Interfaces.hpp"
 #include "Model.hpp"
+#include "SharedTable.hpp"
+#include "Stream.hpp"
+#include "Trace.hpp"
+#include "Uring.hpp"
 
 namespace Processor
 {
@@ -14,11 +21,62 @@ namespace Processor
             size_t InputSize{DefaultSize};
             size_t OutputSize{DefaultSize};
         } Buffer;
+
+        // Histogram is built from evenly spaced chunks of source,
+        // which cover given fraction of it. Full scan by default.
+        struct
+        {
+            double Fraction{1.0};
+            size_t ChunkSize{64 * 1024};
+        } Sample;
+
+        // Decoder peeks given number of bits and takes
+        // up to given number of symbols per lookup.
+        struct
+        {
+            unsigned PeekBits{Helpers::DecodeTable::DefaultPeekBits};
+            unsigned Symbols{Helpers::DecodeTable::MaxSymbols};
+        } Lookup;
+
+        // Number of threads for histogram pass and for decoding.
+        unsigned Threads{1};
+
+        // When set, messages are encoded with the default table and
+        // decoded with the table referenced by their header.
+        const Huffman::SharedTables* Tables{nullptr};
+
+        // When set, data is coded by blocks of stream format,
+        // each with its own table, instead of one table for all.
+        const Stream::Options* Blocks{nullptr};
+
+        // When set, buffers, tables and threads of coding are taken from it.
+        // Threads, which don't fit, aren't started, see also Fit().
+        Budget::Tracker* Memory{nullptr};
+
+        // When set, time and hardware counters of each stage are added to it.
+        Counters::Profile* Profile{nullptr};
+
+        // When set, spans of stages and of each buffer are recorded to it.
+        Trace::Recorder* Trace{nullptr};
     };
 
+    // Bytes which coding with given config and pipeline of reads and
+    // writes takes at most, roughly.
+    size_t Footprint(const Config& aConfig, const Uring::Options* aPipeline = nullptr);
+
+    // Shrinks settings to make footprint fit in aBudget: threads go first,
+    // then requests in flight, blocks and width of decoding table. Blocks,
+    // if given, are the ones config codes with. Throws if even the least
+    // of them don't fit.
+    void Fit(size_t aBudget, Config& aConfig, Stream::Options* aBlocks = nullptr,
+             Uring::Options* aPipeline = nullptr);
+
     void Encode(IStorage::Input&, IStorage::Output&);
     void Encode(IStorage::Input&, IStorage::Output&, const Config&);
 
     void Decode(IStorage::Input&, IStorage::Output&);
     void Decode(IStorage::Input&, IStorage::Output&, const Config&);
+
+    void Train(IStorage::Input&, IStorage::Output&);
+    void Train(IStorage::Input&, IStorage::Output&, const Config&);
 }
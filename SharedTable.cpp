@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "SharedTable.hpp"
+
+namespace Huffman
+{
+    using Model::TableFileHeader;
+
+    namespace
+    {
+        SharedTable::TId Checksum(const std::vector<SymbolInfo>& aEntries)
+        {
+            // FNV-1a over the symbols and their codes.
+            uint32_t hash = 2166136261u;
+
+            auto mix = [&hash](uint32_t aValue) {
+                for (int i = 0; i < 4; ++i)
+                {
+                    hash ^= (aValue >> (i * 8)) & 0xFF;
+                    hash *= 16777619u;
+                }
+            };
+
+            for (const auto& entry : aEntries)
+            {
+                mix(entry.Symbol);
+                mix(static_cast<uint32_t>(entry.Code.Value));
+                mix(static_cast<uint32_t>(entry.Code.Length));
+            }
+
+            return hash;
+        }
+    }
+
+    SharedTable SharedTable::Make(std::vector<SymbolInfo> aEntries)
+    {
+        std::sort(aEntries.begin(), aEntries.end(), [](const SymbolInfo& lhs, const SymbolInfo& rhs) {
+            return lhs.Symbol < rhs.Symbol;
+        });
+
+        auto duplicate = std::adjacent_find(aEntries.begin(), aEntries.end(), [](const SymbolInfo& lhs, const SymbolInfo& rhs) {
+            return lhs.Symbol == rhs.Symbol;
+        });
+        if (duplicate != aEntries.end())
+        {
+            throw std::runtime_error("SharedTable: Duplicate symbol.");
+        }
+
+        SharedTable table;
+        table.Id = Checksum(aEntries);
+
+        for (const auto& entry : aEntries)
+        {
+            table.Codes[entry.Symbol] = entry.Code;
+            table.Lookup.Put(entry);
+        }
+
+        table.Entries = std::move(aEntries);
+        table.Decoding = Helpers::DecodeTable{table.Entries.data(), table.Entries.data() + table.Entries.size()};
+        return table;
+    }
+
+    bool SharedTable::IsComplete() const
+    {
+        return Entries.size() == Codes.size();
+    }
+
+    void SharedTable::Save(IStorage::Output& aOutput) const
+    {
+        TableFileHeader header;
+        header.Magic = TableFileHeader::Signature;
+        header.Id = Id;
+        header.Table.Length = Entries.size();
+
+        aOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+        aOutput.Write(reinterpret_cast<const char*>(Entries.data()), Entries.size() * sizeof(SymbolInfo));
+    }
+
+    SharedTable SharedTable::Make(const Tree& aTree)
+    {
+        std::vector<SymbolInfo> entries;
+        entries.reserve(aTree.Codes.size());
+
+        for (const auto& p : aTree.Codes)
+        {
+            entries.push_back(SymbolInfo{p.first, p.second});
+        }
+
+        return Make(std::move(entries));
+    }
+
+    SharedTable SharedTable::Make(const TCodes& aCodes)
+    {
+        std::vector<SymbolInfo> entries;
+
+        for (size_t symbol = 0; symbol < aCodes.size(); ++symbol)
+        {
+            if (aCodes[symbol].Length)
+            {
+                entries.push_back(SymbolInfo{static_cast<TSymbol>(symbol), aCodes[symbol]});
+            }
+        }
+
+        return Make(std::move(entries));
+    }
+
+    SharedTable SharedTable::Load(IStorage::Input& aInput)
+    {
+        TableFileHeader header;
+        if (aInput.Read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+            header.Magic != TableFileHeader::Signature)
+        {
+            throw std::runtime_error("SharedTable: Not a table file.");
+        }
+
+        if (header.Table.Length > 256)
+        {
+            throw std::runtime_error("SharedTable: Invalid symbols table.");
+        }
+
+        std::vector<SymbolInfo> entries(header.Table.Length);
+        auto size = entries.size() * sizeof(SymbolInfo);
+
+        if (aInput.Read(reinterpret_cast<char*>(entries.data()), size) != size)
+        {
+            throw std::runtime_error("SharedTable: Invalid symbols table.");
+        }
+
+        // Decoder would skip codes it can't take, and lose their symbols.
+        for (const auto& entry : entries)
+        {
+            if (entry.Code.Length <= 0 || entry.Code.Length > Helpers::DecodeTable::MaxCodeLength ||
+                static_cast<uint64_t>(static_cast<uint32_t>(entry.Code.Value)) >> entry.Code.Length)
+            {
+                throw std::runtime_error("SharedTable: Invalid code length.");
+            }
+        }
+
+        auto table = Make(std::move(entries));
+        if (table.Id != header.Id)
+        {
+            throw std::runtime_error("SharedTable: Checksum mismatch.");
+        }
+
+        return table;
+    }
+
+    const SharedTable& SharedTables::Add(SharedTable aTable)
+    {
+        if (Find(aTable.Id))
+        {
+            throw std::runtime_error("SharedTables: Duplicate table id.");
+        }
+
+        mTables.push_back(std::move(aTable));
+        return mTables.back();
+    }
+
+    const SharedTable* SharedTables::Find(SharedTable::TId aId) const
+    {
+        for (const auto& table : mTables)
+        {
+            if (table.Id == aId)
+            {
+                return &table;
+            }
+        }
+        return nullptr;
+    }
+
+    const SharedTable* SharedTables::Default() const
+    {
+        return mTables.empty() ? nullptr : &mTables.front();
+    }
+
+    bool SharedTables::Empty() const
+    {
+        return mTables.empty();
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "DecodeTable.hpp"
+#include "HuffmanTree.hpp"
+#include "Interfaces.hpp"
+#include "Model.hpp"
+#include "SymbolsLookup.hpp"
+
+namespace Huffman
+{
+    using Model::SymbolInfo;
+
+    // Code table that is trained once and referenced by its Id
+    // from every encoded message, instead of being embedded.
+    struct SharedTable
+    {
+        using TId = uint32_t;
+        using TCodes = std::array<SymbolCode, 256>;
+
+        TId Id{0};
+        std::vector<SymbolInfo> Entries;
+
+        TCodes Codes{};
+        Helpers::SymbolsLookup Lookup;
+        Helpers::DecodeTable Decoding;
+
+        bool IsComplete() const;
+
+        void Save(IStorage::Output& aOutput) const;
+
+        static SharedTable Make(const Tree& aTree);
+        static SharedTable Make(const TCodes& aCodes);
+        static SharedTable Make(std::vector<SymbolInfo> aEntries);
+        static SharedTable Load(IStorage::Input& aInput);
+    };
+
+    class SharedTables
+    {
+    public:
+        const SharedTable& Add(SharedTable aTable);
+
+        const SharedTable* Find(SharedTable::TId aId) const;
+        const SharedTable* Default() const;
+
+        bool Empty() const;
+
+    private:
+        std::vector<SharedTable> mTables;
+    };
+}
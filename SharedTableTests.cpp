@@ -0,0 +1,129 @@
+#include "Memory.hpp"
+#include "Processor.hpp"
+#include "SharedTable.hpp"
+#include "TestsBase.hpp"
+
+using Huffman::SharedTable;
+using Huffman::SharedTables;
+using Model::SharedFileHeader;
+
+SharedTable TrainOn(const std::string& aCorpus)
+{
+    Memory::Reader corpus{aCorpus};
+    Memory::Writer file;
+    Processor::Train(corpus, file);
+
+    Memory::Reader reader{file.Data()};
+    return SharedTable::Load(reader);
+}
+
+TEST(SharedTable, ShouldTrainCodeForEachSymbol)
+{
+    auto table = TrainOn("AAAABBC");
+
+    EXPECT_TRUE(table.IsComplete());
+    EXPECT_LT(table.Codes['A'].Length, table.Codes['Z'].Length);
+    EXPECT_EQ(256u, table.Lookup.Size());
+}
+
+TEST(SharedTable, ShouldKeepIdAfterReload)
+{
+    Huffman::TreeBuilder builder;
+    builder.Process({'A', 'A', 'B'});
+    auto table = SharedTable::Make(builder.Build());
+
+    Memory::Writer file;
+    table.Save(file);
+
+    Memory::Reader reader{file.Data()};
+    auto loaded = SharedTable::Load(reader);
+
+    EXPECT_EQ(table.Id, loaded.Id);
+    ASSERT_EQ(2u, loaded.Entries.size());
+    EXPECT_FALSE(loaded.IsComplete());
+}
+
+TEST(SharedTable, ShouldRejectCorruptedFile)
+{
+    Huffman::TreeBuilder builder;
+    builder.Process({'A', 'A', 'B'});
+
+    Memory::Writer file;
+    SharedTable::Make(builder.Build()).Save(file);
+
+    auto data = file.Data();
+    data.back() ^= 0x01;
+
+    Memory::Reader reader{data};
+    EXPECT_ANY_THROW(SharedTable::Load(reader));
+
+    Memory::Reader empty{""};
+    EXPECT_ANY_THROW(SharedTable::Load(empty));
+}
+
+TEST(SharedTable, ShouldRejectCodesLongerThanDecoderTakes)
+{
+    auto table = SharedTable::Make(std::vector<Model::SymbolInfo>{{'A', {0, 1}}, {'B', {2, 2}}, {'C', {3, 40}}});
+
+    Memory::Writer file;
+    table.Save(file);
+
+    Memory::Reader reader{file.Data()};
+    EXPECT_THROW(SharedTable::Load(reader), std::runtime_error);
+}
+
+TEST(SharedTable, ShouldEncodeAndDecodeWithSharedTable)
+{
+    SharedTables tables;
+    tables.Add(TrainOn("hello, shared world"));
+
+    Processor::Config config;
+    config.Tables = &tables;
+
+    const std::string message = "hello, unseen symbols \x01\xFF";
+
+    Memory::Reader source{message};
+    Memory::Writer encoded;
+    Processor::Encode(source, encoded, config);
+
+    auto header = reinterpret_cast<const SharedFileHeader*>(encoded.Data().data());
+    EXPECT_EQ(message.size(), header->FileSize);
+    EXPECT_EQ(tables.Default()->Id, header->TableId);
+
+    Memory::Reader input{encoded.Data()};
+    Memory::Writer decoded;
+    Processor::Decode(input, decoded, config);
+
+    EXPECT_EQ(message, decoded.Data());
+}
+
+TEST(SharedTable, ShouldNotDecodeWithUnknownTable)
+{
+    SharedTables tables;
+    tables.Add(TrainOn(std::string(100, 'a')));
+
+    SharedTables others;
+    others.Add(TrainOn(std::string(100, 'z')));
+
+    Processor::Config config;
+    config.Tables = &tables;
+
+    Memory::Reader source{std::string{"first"}};
+    Memory::Writer encoded;
+    Processor::Encode(source, encoded, config);
+
+    config.Tables = &others;
+
+    Memory::Reader input{encoded.Data()};
+    Memory::Writer decoded;
+    EXPECT_ANY_THROW(Processor::Decode(input, decoded, config));
+
+    // File of known table id, but not of shared table format, is refused too.
+    config.Tables = &tables;
+
+    auto other = encoded.Data();
+    other[0] ^= 0x01;
+
+    Memory::Reader corrupted{other};
+    EXPECT_THROW(Processor::Decode(corrupted, decoded, config), std::runtime_error);
+}
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Pool.hpp"
+#include "SpeculativeDecoder.hpp"
+
+namespace Helpers
+{
+    // Zeros after data let peek read whole words at any position.
+    static constexpr size_t Padding = 16;
+
+    // Code of the last symbol of round may cross its end.
+    static constexpr size_t Overlap = 32;
+
+    SpeculativeDecoder::SpeculativeDecoder(const SymbolInfo* aBegin, const SymbolInfo* aEnd, const Options& aOptions)
+      : mOptions{aOptions}
+      , mSingle{aBegin, aEnd, DecodeTable::DefaultPeekBits, 1}
+      , mMulti{aBegin, aEnd, DecodeTable::DefaultPeekBits, DecodeTable::MaxSymbols}
+    {
+        if (aOptions.Threads == 0 || aOptions.ChunkSize == 0 || aOptions.Window == 0)
+        {
+            throw std::invalid_argument("SpeculativeDecoder: Invalid options.");
+        }
+    }
+
+    size_t SpeculativeDecoder::Fallbacks() const
+    {
+        return mFallbacks;
+    }
+
+    uint64_t SpeculativeDecoder::Peek(uint64_t aPosition, unsigned aLength) const
+    {
+        const auto data = mData.data() + (aPosition >> 3);
+
+        uint64_t word = 0;
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        std::memcpy(&word, data, sizeof(word));
+        word = __builtin_bswap64(word);
+#else
+        for (int i = 0; i < 8; ++i)
+        {
+            word = (word << 8) | data[i];
+        }
+#endif
+
+        return (word << (aPosition & 7)) >> (64 - aLength);
+    }
+
+    bool SpeculativeDecoder::DecodeOne(uint64_t& aPosition, std::string& aSymbols) const
+    {
+        const auto& entry = mSingle.Find(static_cast<uint32_t>(Peek(aPosition, mSingle.PeekBits())));
+        if (entry.Count)
+        {
+            aSymbols.push_back(static_cast<char>(entry.Symbols[0]));
+            aPosition += entry.Bits;
+            return true;
+        }
+
+        for (auto length = mSingle.PeekBits() + 1; length <= mSingle.MaxLength(); ++length)
+        {
+            auto find = mSingle.Long().Find(static_cast<int>(Peek(aPosition, length)), static_cast<int>(length));
+            if (find.Success)
+            {
+                aSymbols.push_back(static_cast<char>(find.Symbol));
+                aPosition += length;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Decodes symbols which start before given end. Invalid code in true
+    // stream is an error, unless it is padding of the last byte, while
+    // speculative decoding skips a bit and goes on.
+    void SpeculativeDecoder::DecodeRange(Chunk& aChunk, uint64_t& aPosition, uint64_t aEnd, bool aTrue) const
+    {
+        const auto peek = mMulti.PeekBits();
+
+        while (aPosition < aEnd)
+        {
+            if (aPosition + peek <= aEnd)
+            {
+                const auto& entry = mMulti.Find(static_cast<uint32_t>(Peek(aPosition, peek)));
+                if (entry.Count)
+                {
+                    aChunk.Symbols.append(reinterpret_cast<const char*>(entry.Symbols), entry.Count);
+                    aPosition += entry.Bits;
+                    continue;
+                }
+            }
+
+            if (DecodeOne(aPosition, aChunk.Symbols))
+            {
+                continue;
+            }
+
+            if (aPosition >= mPaddingStart)
+            {
+                aPosition = aEnd;
+                break;
+            }
+
+            if (aTrue)
+            {
+                throw std::runtime_error("Decoder: Invalid code.");
+            }
+
+            aChunk.Invalid = true;
+            aChunk.LastInvalid = aPosition++;
+        }
+    }
+
+    void SpeculativeDecoder::Speculate(Chunk& aChunk) const
+    {
+        auto position = aChunk.Begin;
+
+        // Boundaries are taken symbol by symbol, the rest goes by table entries.
+        auto window = std::min<uint64_t>(aChunk.Begin + mOptions.Window, aChunk.End);
+        while (position < window)
+        {
+            aChunk.Boundaries.emplace_back(position, aChunk.Symbols.size());
+
+            if (!DecodeOne(position, aChunk.Symbols))
+            {
+                aChunk.Invalid = true;
+                aChunk.LastInvalid = position++;
+            }
+        }
+
+        DecodeRange(aChunk, position, aChunk.End, false);
+        aChunk.Stop = position;
+    }
+
+    void SpeculativeDecoder::Decode(IStorage::Input& aInput, size_t aOffset, size_t aSymbols, IStorage::Output& aOutput)
+    {
+        const uint64_t size = aInput.Size();
+        if (size < aOffset)
+        {
+            throw std::runtime_error("Decoder: Unexpected end of file.");
+        }
+
+        Pool::WorkStealing pool{mOptions.Threads};
+
+        // Absolute position of the next true symbol, in bits from data start.
+        uint64_t next = 0;
+        const uint64_t dataSize = size - aOffset;
+
+        const auto ratio = dataSize ? static_cast<double>(aSymbols) / dataSize * 1.1 : 1.0;
+
+        size_t left = aSymbols;
+        while (left && (next >> 3) < dataSize)
+        {
+            const auto byte = next >> 3;
+            const auto roundSize = std::min<uint64_t>(dataSize - byte, uint64_t{mOptions.ChunkSize} * mOptions.Threads);
+
+            // Codes of the last symbols may cross round end.
+            const auto readSize = std::min<uint64_t>(dataSize - byte, roundSize + Overlap);
+
+            mData.assign(readSize + Padding, 0);
+            if (aInput.ReadAt(aOffset + byte, reinterpret_cast<char*>(mData.data()), readSize) != readSize)
+            {
+                throw std::runtime_error("Decoder: Unexpected end of file.");
+            }
+
+            // Last byte may be padded, if round reaches end of data.
+            mPaddingStart = byte + readSize == dataSize ? (readSize - 1) * 8 : (readSize + Padding) * 8;
+
+            const auto count = static_cast<size_t>(std::max<uint64_t>(
+                1, std::min<uint64_t>(mOptions.Threads, roundSize / std::max<size_t>(1, mOptions.Window / 8))));
+
+            std::vector<Chunk> chunks(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                chunks[i].Begin = i == 0 ? next & 7 : roundSize * i / count * 8;
+                chunks[i].End = roundSize * (i + 1) / count * 8;
+
+                // Room for as many symbols per byte as in the whole file.
+                chunks[i].Symbols.reserve((chunks[i].End - chunks[i].Begin) / 8 * ratio + 64);
+            }
+
+            std::vector<Pool::TJob> jobs;
+            jobs.push_back([this, &chunks]() {
+                auto position = chunks[0].Begin;
+                DecodeRange(chunks[0], position, chunks[0].End, true);
+                chunks[0].Stop = position;
+            });
+
+            for (size_t i = 1; i < count; ++i)
+            {
+                jobs.push_back([this, &chunks, i]() { Speculate(chunks[i]); });
+            }
+
+            pool.Run(std::move(jobs));
+
+            // Join seams in order, true chunk continues until it meets the next one.
+            size_t current = 0;
+            for (size_t i = 1; i < count; ++i)
+            {
+                auto& chunk = chunks[current];
+                auto& following = chunks[i];
+
+                auto position = chunk.Stop;
+                auto boundary = following.Boundaries.begin();
+
+                for (;;)
+                {
+                    while (boundary != following.Boundaries.end() && boundary->first < position)
+                    {
+                        ++boundary;
+                    }
+
+                    if (boundary == following.Boundaries.end() || boundary->first == position)
+                    {
+                        break;
+                    }
+
+                    if (!DecodeOne(position, chunk.Symbols))
+                    {
+                        if (position < mPaddingStart)
+                        {
+                            throw std::runtime_error("Decoder: Invalid code.");
+                        }
+
+                        boundary = following.Boundaries.end();
+                        break;
+                    }
+                }
+
+                if (boundary != following.Boundaries.end())
+                {
+                    if (following.Invalid && following.LastInvalid >= position)
+                    {
+                        throw std::runtime_error("Decoder: Invalid code.");
+                    }
+
+                    following.Symbols.erase(0, boundary->second);
+                    current = i;
+                    continue;
+                }
+
+                // Chunks never met, so true chunk takes the following one.
+                mFallbacks++;
+
+                DecodeRange(chunk, position, following.End, true);
+                chunk.Stop = position;
+
+                following.Symbols.clear();
+            }
+
+            for (const auto& chunk : chunks)
+            {
+                auto count = std::min(left, chunk.Symbols.size());
+                aOutput.Write(chunk.Symbols.data(), count);
+                left -= count;
+            }
+
+            next = byte * 8 + chunks[current].Stop;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "DecodeTable.hpp"
+#include "Interfaces.hpp"
+#include "Model.hpp"
+
+namespace Helpers
+{
+    // Decodes single stream on several threads. Stream is split into chunks
+    // at byte boundaries, and each chunk but the first is decoded from its
+    // first bit, which is likely a middle of some code. Huffman codes soon
+    // get back in step, so previous chunk decoded past its end meets one of
+    // symbol boundaries seen by the next chunk. Symbols before that point
+    // are dropped from the next chunk. If chunks never meet, the next chunk
+    // is decoded again from the true position.
+    class SpeculativeDecoder
+    {
+    public:
+        struct Options
+        {
+            unsigned Threads{2};
+
+            // Encoded bytes per chunk, chunks of all threads make a round.
+            size_t ChunkSize{4 * 1024 * 1024};
+
+            // Number of bits at chunk start, where boundaries are recorded.
+            size_t Window{64 * 1024};
+        };
+
+        SpeculativeDecoder(const SymbolInfo* aBegin, const SymbolInfo* aEnd, const Options& aOptions);
+
+        // Decodes given number of symbols from encoded data,
+        // which starts at given offset of input.
+        void Decode(IStorage::Input& aInput, size_t aOffset, size_t aSymbols, IStorage::Output& aOutput);
+
+        // Number of chunks, which were decoded again from true position.
+        size_t Fallbacks() const;
+
+    private:
+        struct Chunk
+        {
+            uint64_t Begin;
+            uint64_t End;
+
+            // Position right after the last decoded symbol.
+            uint64_t Stop;
+
+            std::string Symbols;
+
+            // Symbol start positions near chunk start, with number of symbols before each.
+            std::vector<std::pair<uint64_t, size_t>> Boundaries;
+
+            bool Invalid{false};
+            uint64_t LastInvalid{0};
+        };
+
+        uint64_t Peek(uint64_t aPosition, unsigned aLength) const;
+
+        bool DecodeOne(uint64_t& aPosition, std::string& aSymbols) const;
+        void DecodeRange(Chunk& aChunk, uint64_t& aPosition, uint64_t aEnd, bool aTrue) const;
+
+        void Speculate(Chunk& aChunk) const;
+
+    private:
+        Options mOptions;
+
+        DecodeTable mSingle;
+        DecodeTable mMulti;
+
+        // Encoded data of current round, padded by zeros.
+        std::vector<uint8_t> mData;
+        uint64_t mPaddingStart{0};
+
+        size_t mFallbacks{0};
+    };
+}
@@ -0,0 +1,107 @@
+#include "Memory.hpp"
+#include "Processor.hpp"
+#include "SpeculativeDecoder.hpp"
+#include "TestsBase.hpp"
+
+using Helpers::SpeculativeDecoder;
+using Model::FileHeader;
+
+namespace
+{
+    std::string MakeText(size_t aSize)
+    {
+        const std::string words[] = {"huffman ", "code ", "tree ", "a ", "decoder ", "symbol\n", "zz ", "0123 "};
+
+        std::string text;
+        for (size_t i = 0; text.size() < aSize; ++i)
+        {
+            text += words[(i * 7 + i / 5) % 8];
+        }
+        text.resize(aSize);
+        return text;
+    }
+
+    std::string Encode(const std::string& aSource)
+    {
+        Memory::Reader input{aSource};
+        Memory::Writer output;
+        Processor::Encode(input, output);
+        return output.Data();
+    }
+
+    std::string Decode(const std::string& aEncoded, const SpeculativeDecoder::Options& aOptions, size_t* aFallbacks)
+    {
+        auto header = reinterpret_cast<const FileHeader*>(aEncoded.data());
+        auto offset = sizeof(FileHeader) + header->Table.Length * sizeof(FileHeader::SymbolsTable::Entry);
+
+        SpeculativeDecoder decoder{header->Table.Entries, header->Table.Entries + header->Table.Length, aOptions};
+
+        Memory::Reader input{aEncoded};
+        Memory::Writer output;
+        decoder.Decode(input, offset, header->FileSize, output);
+
+        if (aFallbacks)
+        {
+            *aFallbacks = decoder.Fallbacks();
+        }
+        return output.Data();
+    }
+}
+
+TEST(SpeculativeDecoder, ShouldDecodeChunksInParallel)
+{
+    auto source = MakeText(200000);
+    auto encoded = Encode(source);
+
+    SpeculativeDecoder::Options options;
+    options.Threads = 4;
+    options.ChunkSize = 4096;
+    options.Window = 1024;
+
+    size_t fallbacks = 0;
+    EXPECT_EQ(source, Decode(encoded, options, &fallbacks));
+    EXPECT_EQ(0u, fallbacks);
+}
+
+TEST(SpeculativeDecoder, ShouldFallBackIfChunksNeverMeet)
+{
+    auto source = MakeText(50000);
+    auto encoded = Encode(source);
+
+    // Only the very first bit of chunk is a known boundary.
+    SpeculativeDecoder::Options options;
+    options.Threads = 3;
+    options.ChunkSize = 1000;
+    options.Window = 1;
+
+    size_t fallbacks = 0;
+    EXPECT_EQ(source, Decode(encoded, options, &fallbacks));
+    EXPECT_LT(0u, fallbacks);
+}
+
+TEST(SpeculativeDecoder, ShouldDecodeWithSingleThread)
+{
+    auto source = MakeText(10000);
+    auto encoded = Encode(source);
+
+    SpeculativeDecoder::Options options;
+    options.Threads = 1;
+    options.ChunkSize = 100;
+
+    EXPECT_EQ(source, Decode(encoded, options, nullptr));
+}
+
+TEST(SpeculativeDecoder, ShouldBeUsedByProcessorForLargeFiles)
+{
+    auto source = MakeText(3 * 1024 * 1024);
+    auto encoded = Encode(source);
+
+    Processor::Config config;
+    config.Threads = 4;
+
+    Memory::Reader input{encoded};
+    Memory::Writer output;
+    Processor::Decode(input, output, config);
+
+    EXPECT_EQ(source, output.Data());
+}
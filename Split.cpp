@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Model.hpp"
+#include "Split.hpp"
+
+namespace Split
+{
+    namespace
+    {
+        using THistograms = std::vector<uint32_t>;
+
+        // Histograms of all windows from the first up to each window bound.
+        class Prefixes
+        {
+        public:
+            Prefixes(const uint8_t* aData, size_t aSize, size_t aWindow)
+              : mCount{(aSize + aWindow - 1) / aWindow}
+              , mHistograms((mCount + 1) * 256)
+            {
+                for (size_t window = 0; window < mCount; ++window)
+                {
+                    auto current = &mHistograms[(window + 1) * 256];
+                    std::copy(current - 256, current, current);
+
+                    auto end = std::min(aSize, (window + 1) * aWindow);
+                    for (auto i = window * aWindow; i < end; ++i)
+                    {
+                        current[aData[i]]++;
+                    }
+                }
+            }
+
+            size_t Count() const
+            {
+                return mCount;
+            }
+
+            double Cost(size_t aFirst, size_t aLast) const
+            {
+                size_t histogram[256];
+                for (size_t symbol = 0; symbol < 256; ++symbol)
+                {
+                    histogram[symbol] = mHistograms[aLast * 256 + symbol] - mHistograms[aFirst * 256 + symbol];
+                }
+                return Split::Cost(histogram);
+            }
+
+        private:
+            size_t mCount;
+            THistograms mHistograms;
+        };
+
+        // Halves windows from aFirst to aLast at the best bound, while both
+        // halves cost less than the whole, and collects the bounds.
+        void Halve(const Prefixes& aPrefixes, size_t aFirst, size_t aLast, unsigned aDepth, std::vector<size_t>& aBounds)
+        {
+            if (aLast - aFirst < 2 || aDepth == MaxDepth)
+            {
+                return;
+            }
+
+            auto best = aPrefixes.Cost(aFirst, aLast);
+            size_t bound = 0;
+
+            for (auto middle = aFirst + 1; middle < aLast; ++middle)
+            {
+                auto cost = aPrefixes.Cost(aFirst, middle) + aPrefixes.Cost(middle, aLast);
+                if (cost < best)
+                {
+                    best = cost;
+                    bound = middle;
+                }
+            }
+
+            if (bound == 0)
+            {
+                return;
+            }
+
+            Halve(aPrefixes, aFirst, bound, aDepth + 1, aBounds);
+            aBounds.push_back(bound);
+            Halve(aPrefixes, bound, aLast, aDepth + 1, aBounds);
+        }
+    }
+
+    double Cost(const size_t* aHistogram)
+    {
+        size_t total = 0;
+        size_t symbols = 0;
+        for (size_t symbol = 0; symbol < 256; ++symbol)
+        {
+            total += aHistogram[symbol];
+            symbols += aHistogram[symbol] != 0;
+        }
+
+        double bits = 0.0;
+        for (size_t symbol = 0; symbol < 256; ++symbol)
+        {
+            if (aHistogram[symbol])
+            {
+                bits += aHistogram[symbol] * std::log2(static_cast<double>(total) / aHistogram[symbol]);
+            }
+        }
+
+        return bits / 8 + symbols * sizeof(Model::BlockHeader::Entry) + sizeof(Model::BlockHeader);
+    }
+
+    std::vector<size_t> Parts(const uint8_t* aData, size_t aSize)
+    {
+        const auto window = std::max(Window, (aSize + MaxWindows - 1) / MaxWindows);
+        const Prefixes prefixes{aData, aSize, window};
+
+        std::vector<size_t> bounds;
+        Halve(prefixes, 0, prefixes.Count(), 0, bounds);
+
+        std::vector<size_t> ends;
+        for (auto bound : bounds)
+        {
+            ends.push_back(bound * window);
+        }
+        ends.push_back(aSize);
+
+        return ends;
+    }
+}
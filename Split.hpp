@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Split
+{
+    // Data is split at window bounds only. Long data takes larger
+    // windows, so that there are no more than MaxWindows of them.
+    static constexpr size_t Window = 4096;
+    static constexpr size_t MaxWindows = 1024;
+
+    // Parts are halved no more than this many times.
+    static constexpr unsigned MaxDepth = 8;
+
+    // Estimated size of data of given histogram coded as a block:
+    // entropy of data, its table and block header.
+    double Cost(const size_t* aHistogram);
+
+    // Ends of parts of data, so that each part coded with its own table
+    // is smaller than all of them with one table, the last end is aSize.
+    std::vector<size_t> Parts(const uint8_t* aData, size_t aSize);
+}
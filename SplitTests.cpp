@@ -0,0 +1,55 @@
+#include <random>
+
+#include "Model.hpp"
+#include "Split.hpp"
+#include "TestsBase.hpp"
+
+namespace
+{
+    std::vector<uint8_t> Text(size_t aSize)
+    {
+        std::vector<uint8_t> text;
+        for (size_t i = 0; text.size() < aSize; ++i)
+        {
+            text.push_back(static_cast<uint8_t>("the quick brown fox "[i % 20]));
+        }
+        return text;
+    }
+}
+
+TEST(Split, ShouldEstimateCodedSize)
+{
+    size_t histogram[256]{};
+    EXPECT_DOUBLE_EQ(sizeof(Model::BlockHeader), Split::Cost(histogram));
+
+    // Two equal symbols take a bit each.
+    histogram['a'] = 800;
+    histogram['b'] = 800;
+    EXPECT_DOUBLE_EQ(200 + 2 * sizeof(Model::BlockHeader::Entry) + sizeof(Model::BlockHeader),
+                     Split::Cost(histogram));
+}
+
+TEST(Split, ShouldKeepUniformDataWhole)
+{
+    auto text = Text(100000);
+    EXPECT_EQ(std::vector<size_t>{text.size()}, Split::Parts(text.data(), text.size()));
+
+    EXPECT_EQ(std::vector<size_t>{0}, Split::Parts(nullptr, 0));
+}
+
+TEST(Split, ShouldSplitWhereDataChanges)
+{
+    std::mt19937 random{1};
+
+    // Text, then binary, then text again, as in archive of files.
+    auto data = Text(8 * Split::Window);
+    for (size_t i = 0; i < 4 * Split::Window; ++i)
+    {
+        data.push_back(static_cast<uint8_t>(random()));
+    }
+    auto tail = Text(3 * Split::Window + 100);
+    data.insert(data.end(), tail.begin(), tail.end());
+
+    const std::vector<size_t> expected{8 * Split::Window, 12 * Split::Window, data.size()};
+    EXPECT_EQ(expected, Split::Parts(data.data(), data.size()));
+}
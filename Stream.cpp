@@ -0,0 +1,1114 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "Kernels.hpp"
+#include "Split.hpp"
+#include "Stream.hpp"
+
+namespace Stream
+{
+    using Model::BlockHeader;
+    using Model::StreamHeader;
+
+    static constexpr size_t BufferSize = 4096;
+
+    // Packed transform takes up to twice the block, which has to fit its length.
+    // Parts of matches block have the same limit.
+    static constexpr size_t MaxTransformSize = 1 << 30;
+
+    size_t EncoderFootprint(const Options& aOptions)
+    {
+        const auto block = aOptions.BlockSize;
+
+        // Block and its coded data.
+        auto size = 2 * block;
+
+        // Suffix sorting takes text and suffixes of four bytes per byte,
+        // packed transform up to twice the block.
+        if (aOptions.Transform)
+        {
+            size += 12 * block;
+        }
+
+        // Sequences and their coded parts, chains of window and hash heads.
+        if (aOptions.Matches)
+        {
+            size += 2 * block + (aOptions.Matches->Window + 32 * 1024) * sizeof(int64_t);
+        }
+
+        if (aOptions.Entropy != Coder::Huffman)
+        {
+            size += 2 * block;
+        }
+
+        if (aOptions.Split)
+        {
+            size += Split::MaxWindows * 256 * sizeof(uint32_t);
+        }
+
+        return size;
+    }
+
+    size_t DecoderFootprint(size_t aBlockSize)
+    {
+        // Transformed block takes the most: packed, sorted and plain
+        // block, and links of inverse transform of four bytes per byte.
+        return 8 * aBlockSize;
+    }
+
+    Encoder::Encoder(IStorage::Output& aOutput, const Options& aOptions)
+      : mOutput{aOutput}
+      , mBits{aOutput, BufferSize}
+      , mBlockSize{aOptions.BlockSize}
+      , mTransform{aOptions.Transform}
+      , mEntropy{aOptions.Entropy}
+      , mSplit{aOptions.Split}
+      , mMatch{aOptions.Matches != nullptr}
+    {
+        if (aOptions.BlockSize == 0 || aOptions.BlockSize > std::numeric_limits<uint32_t>::max() ||
+            ((aOptions.Transform || aOptions.Matches) && aOptions.BlockSize > MaxTransformSize))
+        {
+            throw std::invalid_argument("Stream: Invalid block size.");
+        }
+
+        if (mMatch)
+        {
+            if (!aOptions.Matches->Valid())
+            {
+                throw std::invalid_argument("Stream: Invalid match options.");
+            }
+            mMatches = *aOptions.Matches;
+        }
+
+        mBlock.reset(new char[mBlockSize]);
+    }
+
+    void Encoder::Feed(const char* aData, size_t aSize)
+    {
+        if (mFinished)
+        {
+            throw std::logic_error("Stream: Encoder is finished.");
+        }
+
+        while (aSize)
+        {
+            auto count = std::min(aSize, mBlockSize - mTaken);
+            std::memcpy(mBlock.get() + mTaken, aData, count);
+
+            mTaken += count;
+            aData += count;
+            aSize -= count;
+
+            if (mTaken == mBlockSize)
+            {
+                WriteBlock();
+            }
+        }
+    }
+
+    void Encoder::Flush()
+    {
+        if (mFinished)
+        {
+            throw std::logic_error("Stream: Encoder is finished.");
+        }
+
+        if (mTaken)
+        {
+            WriteBlock();
+        }
+        else
+        {
+            Start();
+        }
+    }
+
+    void Encoder::Finish()
+    {
+        Flush();
+
+        BlockHeader end{};
+        mOutput.Write(reinterpret_cast<const char*>(&end), sizeof(end));
+
+        mFinished = true;
+    }
+
+    void Encoder::Start()
+    {
+        if (!mStarted)
+        {
+            StreamHeader header;
+            header.Magic = StreamHeader::Signature;
+            header.BlockSize = static_cast<uint32_t>(mBlockSize);
+
+            mOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+            mStarted = true;
+        }
+    }
+
+    // Codes of block data and size of data coded with them. Ans form
+    // is coded ahead, it is used instead if Mode says so.
+    struct Coding
+    {
+        BlockHeader::Entry Table[256];
+        size_t Length{0};
+        uint64_t Bits{0};
+        Kernels::CodeTable Codes;
+
+        Huffman::THistogram Histogram{};
+
+        uint8_t Mode{BlockHeader::Huffman};
+        BlockHeader::Weight Weights[256];
+        BlockHeader::Final Final{};
+        Ans::Encoded Encoded;
+
+        size_t Size() const
+        {
+            if (Mode == BlockHeader::Ans)
+            {
+                return Length * sizeof(BlockHeader::Weight) + sizeof(Final) + Encoded.Bits.size();
+            }
+            return Length * sizeof(BlockHeader::Entry) + (Bits + 7) / 8;
+        }
+    };
+
+    // Encoded size is known from code lengths before encoding, while
+    // Ans form has to be coded to know its size.
+    void Plan(const Model::TSymbol* aData, size_t aSize, Huffman::FlatTreeBuilder& aBuilder, Coding& aCoding,
+              Coder aCoder = Coder::Huffman)
+    {
+        auto& histogram = aCoding.Histogram;
+        Kernels::Histogram(aData, aSize, histogram.data());
+
+        const auto& codes = aBuilder.Build(histogram);
+
+        for (size_t symbol = 0; symbol < codes.size(); ++symbol)
+        {
+            if (codes[symbol].Length)
+            {
+                aCoding.Bits += static_cast<uint64_t>(histogram[symbol]) * codes[symbol].Length;
+                aCoding.Table[aCoding.Length++] = BlockHeader::Entry{static_cast<Model::TSymbol>(symbol),
+                                                                     static_cast<uint8_t>(codes[symbol].Length)};
+                aCoding.Codes.Put(static_cast<Model::TSymbol>(symbol), codes[symbol].Value, codes[symbol].Length);
+            }
+        }
+
+        if (aCoder == Coder::Huffman || aSize == 0)
+        {
+            return;
+        }
+
+        const auto log = Ans::TableLog(aSize, aCoding.Length);
+        const auto counts = Ans::Normalize(histogram, aSize, log);
+
+        Ans::Encoder{counts, log}.Encode(aData, aSize, aCoding.Encoded);
+
+        for (size_t i = 0; i < aCoding.Length; ++i)
+        {
+            const auto symbol = aCoding.Table[i].Symbol;
+            aCoding.Weights[i] = BlockHeader::Weight{symbol, 0, counts[symbol]};
+        }
+
+        aCoding.Final.States[0] = aCoding.Encoded.States[0];
+        aCoding.Final.States[1] = aCoding.Encoded.States[1];
+        aCoding.Final.TableLog = static_cast<uint8_t>(log);
+        aCoding.Final.Padding = aCoding.Encoded.Padding;
+
+        const auto huffman = aCoding.Size();
+        aCoding.Mode = BlockHeader::Ans;
+
+        if (aCoder == Coder::Best && aCoding.Size() >= huffman)
+        {
+            aCoding.Mode = BlockHeader::Huffman;
+        }
+    }
+
+    // Size of data coded with given codes, unless some of its symbols have none.
+    bool Cost(const Kernels::CodeTable& aCodes, const Huffman::THistogram& aHistogram, size_t& aSize)
+    {
+        uint64_t bits = 0;
+        for (size_t symbol = 0; symbol < aHistogram.size(); ++symbol)
+        {
+            if (aHistogram[symbol] && !aCodes.Lengths[symbol])
+            {
+                return false;
+            }
+            bits += static_cast<uint64_t>(aHistogram[symbol]) * aCodes.Lengths[symbol];
+        }
+
+        aSize = static_cast<size_t>((bits + 7) / 8);
+        return true;
+    }
+
+    // Long data is coded by pairs of symbols.
+    void EncodeSymbols(Helpers::BitsWriter& aBits, const Model::TSymbol* aData, size_t aSize,
+                       const Kernels::CodeTable& aCodes)
+    {
+        if (Helpers::PairCodes::Pays(aSize))
+        {
+            aBits.Encode(aData, aSize, Helpers::PairCodes{aCodes});
+        }
+        else
+        {
+            aBits.Encode(aData, aSize, aCodes);
+        }
+    }
+
+    void Encoder::WritePart(const Model::TSymbol* aData, size_t aSize, const Coding& aCoding)
+    {
+        BlockHeader header{};
+        header.Size = static_cast<uint32_t>(aSize);
+
+        // Incompressible data is stored as is.
+        if (aCoding.Size() >= aSize)
+        {
+            header.Mode = BlockHeader::Stored;
+            header.EncodedSize = static_cast<uint32_t>(aSize);
+
+            mOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+            mOutput.Write(reinterpret_cast<const char*>(aData), aSize);
+            return;
+        }
+
+        if (aCoding.Mode == BlockHeader::Ans)
+        {
+            header.Mode = BlockHeader::Ans;
+            header.EncodedSize = static_cast<uint32_t>(aCoding.Size());
+            header.TableLength = static_cast<uint16_t>(aCoding.Length);
+
+            const auto& bits = aCoding.Encoded.Bits;
+
+            mOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+            mOutput.Write(reinterpret_cast<const char*>(aCoding.Weights), aCoding.Length * sizeof(BlockHeader::Weight));
+            mOutput.Write(reinterpret_cast<const char*>(&aCoding.Final), sizeof(aCoding.Final));
+            mOutput.Write(reinterpret_cast<const char*>(bits.data()), bits.size());
+            return;
+        }
+
+        header.Mode = BlockHeader::Huffman;
+        header.EncodedSize = static_cast<uint32_t>(aCoding.Size());
+        header.TableLength = static_cast<uint16_t>(aCoding.Length);
+
+        mOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+        mOutput.Write(reinterpret_cast<const char*>(aCoding.Table), aCoding.Length * sizeof(BlockHeader::Entry));
+
+        EncodeSymbols(mBits, aData, aSize, aCoding.Codes);
+        mBits.Flush();
+    }
+
+    void Encoder::WriteBlock()
+    {
+        Start();
+
+        const auto data = reinterpret_cast<const Model::TSymbol*>(mBlock.get());
+
+        const auto ends = mSplit ? Split::Parts(data, mTaken) : std::vector<size_t>{mTaken};
+
+        size_t begin = 0;
+        for (auto end : ends)
+        {
+            Code(data + begin, end - begin);
+            begin = end;
+        }
+
+        mTaken = 0;
+    }
+
+    // Block is written in the smallest of enabled forms.
+    void Encoder::Code(const Model::TSymbol* aData, size_t aSize)
+    {
+        Coding plain;
+        Plan(aData, aSize, mBuilder, plain, mEntropy);
+
+        auto best = std::min(plain.Size(), aSize);
+
+        BlockHeader header{};
+        header.Size = static_cast<uint32_t>(aSize);
+
+        // Codes of the last table may do for this block as well, which
+        // saves its table and rebuilding of decoder. Ans coder has none.
+        size_t repeated = 0;
+        if (mRepeatable && mEntropy != Coder::Ans && Cost(mPrevious, plain.Histogram, repeated) && repeated < best)
+        {
+            best = repeated;
+            header.Mode = BlockHeader::Repeat;
+        }
+
+        BlockHeader::Transformed transformed;
+        Coding packed;
+
+        if (mTransform)
+        {
+            mSorted.resize(aSize);
+            transformed.Primary = Transform::Forward(aData, aSize, mSorted.data());
+
+            Transform::Pack(mSorted.data(), aSize, mPacked);
+            transformed.Length = static_cast<uint32_t>(mPacked.size());
+
+            Plan(mPacked.data(), mPacked.size(), mBuilder, packed);
+
+            auto encodedSize = sizeof(transformed) + packed.Size();
+            if (encodedSize < best)
+            {
+                best = encodedSize;
+                header.Mode = BlockHeader::Huffman;
+                header.Transform = BlockHeader::Bwt;
+            }
+        }
+
+        Coding parts[Lz::Sequences::Count];
+
+        if (mMatch)
+        {
+            Lz::Parse(aData, aSize, mMatches, mSequences);
+
+            size_t encodedSize = 0;
+            for (size_t i = 0; i < Lz::Sequences::Count; ++i)
+            {
+                const auto& part = mSequences.Parts[i];
+                Plan(part.data(), part.size(), mBuilder, parts[i], mEntropy);
+
+                encodedSize += sizeof(BlockHeader) + std::min(parts[i].Size(), part.size());
+            }
+
+            if (encodedSize < best)
+            {
+                best = encodedSize;
+                header.Mode = BlockHeader::Lz;
+                header.Transform = BlockHeader::None;
+            }
+        }
+
+        if (header.Mode == BlockHeader::Lz)
+        {
+            header.EncodedSize = static_cast<uint32_t>(best);
+            mOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            for (size_t i = 0; i < Lz::Sequences::Count; ++i)
+            {
+                const auto& part = mSequences.Parts[i];
+                WritePart(part.data(), part.size(), parts[i]);
+            }
+        }
+        else if (header.Transform == BlockHeader::Bwt)
+        {
+            header.Mode = BlockHeader::Huffman;
+            header.EncodedSize = static_cast<uint32_t>(best);
+            header.TableLength = static_cast<uint16_t>(packed.Length);
+
+            mOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+            mOutput.Write(reinterpret_cast<const char*>(packed.Table), packed.Length * sizeof(BlockHeader::Entry));
+            mOutput.Write(reinterpret_cast<const char*>(&transformed), sizeof(transformed));
+
+            EncodeSymbols(mBits, mPacked.data(), mPacked.size(), packed.Codes);
+            mBits.Flush();
+
+            mPrevious = packed.Codes;
+            mRepeatable = true;
+        }
+        else if (header.Mode == BlockHeader::Repeat)
+        {
+            header.EncodedSize = static_cast<uint32_t>(best);
+            mOutput.Write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            EncodeSymbols(mBits, aData, aSize, mPrevious);
+            mBits.Flush();
+        }
+        else
+        {
+            WritePart(aData, aSize, plain);
+
+            if (plain.Mode == BlockHeader::Huffman && plain.Size() < aSize)
+            {
+                mPrevious = plain.Codes;
+                mRepeatable = true;
+            }
+        }
+    }
+
+    // Writes decoded symbols to caller's buffer. Decoder may ask for more
+    // room than it uses, which is given from spare bytes at the buffer end.
+    class BufferSink
+    {
+    public:
+        BufferSink(char* aOutput, size_t aCapacity, size_t aSize)
+          : mOutput{aOutput}
+          , mCapacity{aCapacity}
+          , mSize{aSize}
+        {
+        }
+
+        char* Reserve(size_t aSize)
+        {
+            mSpilled = mCapacity - mSize < aSize;
+            return mSpilled ? mSpare : mOutput + mSize;
+        }
+
+        void Commit(size_t aCount)
+        {
+            if (mSpilled)
+            {
+                std::memcpy(mOutput + mSize, mSpare, aCount);
+            }
+            mSize += aCount;
+        }
+
+    private:
+        char* mOutput;
+        size_t mCapacity;
+        size_t mSize;
+
+        char mSpare[Helpers::DecodeTable::MaxSymbols];
+        bool mSpilled{false};
+    };
+
+    // Restores canonical codes of block from their lengths.
+    Helpers::DecodeTable MakeTable(const BlockHeader::Entry* aEntries, size_t aLength)
+    {
+        Huffman::FlatTreeBuilder::TCodes codes{};
+        for (size_t i = 0; i < aLength; ++i)
+        {
+            codes[aEntries[i].Symbol].Length = aEntries[i].Length;
+        }
+
+        if (!Huffman::AssignCanonical(codes))
+        {
+            throw std::runtime_error("Stream: Invalid symbols table.");
+        }
+
+        std::vector<Model::SymbolInfo> table;
+        for (size_t symbol = 0; symbol < codes.size(); ++symbol)
+        {
+            if (codes[symbol].Length)
+            {
+                table.push_back(Model::SymbolInfo{static_cast<Model::TSymbol>(symbol), codes[symbol]});
+            }
+        }
+
+        return Helpers::DecodeTable{table.data(), table.data() + table.size()};
+    }
+
+    // Decodes exactly aLength symbols of whole coded data.
+    void DecodeAll(const Helpers::DecodeTable& aTable, const char* aData, size_t aSize, char* aOutput, size_t aLength)
+    {
+        Helpers::SymbolsDecoder decoder{aTable};
+        BufferSink sink{aOutput, aLength, 0};
+
+        auto result = decoder.Decode(aData, aSize, aLength, true, sink);
+        if (result.Produced != aLength)
+        {
+            throw std::runtime_error("Stream: Block is truncated.");
+        }
+    }
+
+    // Lz and Ans blocks are gathered whole, so their sizes are checked
+    // against the most, which blocks of their size are coded to, first.
+    uint64_t MaxGatheredSize(const BlockHeader& aHeader)
+    {
+        const uint64_t size = aHeader.Size;
+
+        // Parts are stored, unless coding makes them smaller, and none
+        // of them exceeds the block.
+        if (aHeader.Mode == BlockHeader::Lz)
+        {
+            return Lz::Sequences::Count * (sizeof(BlockHeader) + size);
+        }
+
+        // Symbol takes up to table log bits.
+        return aHeader.TableLength * sizeof(BlockHeader::Weight) + sizeof(BlockHeader::Final) +
+               (size * Ans::MaxTableLog + 7) / 8;
+    }
+
+    // Data of Ans block is followed by Ans::Slack readable bytes.
+    void DecodeAns(const char* aData, size_t aSize, const BlockHeader& aHeader, uint8_t* aOutput)
+    {
+        const auto weightsSize = aHeader.TableLength * sizeof(BlockHeader::Weight);
+        if (aHeader.TableLength == 0 || aHeader.TableLength > 256 || aSize < weightsSize + sizeof(BlockHeader::Final))
+        {
+            throw std::runtime_error("Stream: Invalid block.");
+        }
+
+        Ans::TCounts counts{};
+        for (size_t i = 0; i < aHeader.TableLength; ++i)
+        {
+            BlockHeader::Weight weight;
+            std::memcpy(&weight, aData + i * sizeof(weight), sizeof(weight));
+            counts[weight.Symbol] = weight.Count;
+        }
+
+        BlockHeader::Final final;
+        std::memcpy(&final, aData + weightsSize, sizeof(final));
+
+        const auto offset = weightsSize + sizeof(final);
+        Ans::Decoder decoder{counts, final.TableLog};
+
+        if (!decoder.Decode(reinterpret_cast<const uint8_t*>(aData + offset), aSize - offset, final.Padding,
+                            final.States, aOutput, aHeader.Size))
+        {
+            throw std::runtime_error("Stream: Invalid ans block.");
+        }
+    }
+
+    // Parts of Lz block are nested blocks, one after another.
+    void UnfoldMatches(const char* aData, size_t aSize, size_t aBlockSize, Lz::Sequences& aSequences, uint8_t* aOutput)
+    {
+        for (auto& part : aSequences.Parts)
+        {
+            BlockHeader header;
+            if (aSize < sizeof(header))
+            {
+                throw std::runtime_error("Stream: Invalid matches block.");
+            }
+
+            std::memcpy(&header, aData, sizeof(header));
+            aData += sizeof(header);
+            aSize -= sizeof(header);
+
+            const auto tableSize = header.TableLength * sizeof(BlockHeader::Entry);
+            if (header.Size > aBlockSize || header.EncodedSize > aSize || header.Transform ||
+                (header.Mode == BlockHeader::Stored && header.EncodedSize != header.Size) ||
+                (header.Mode == BlockHeader::Huffman &&
+                 (header.TableLength == 0 || header.TableLength > 256 || header.EncodedSize < tableSize)) ||
+                header.Mode == BlockHeader::Lz || header.Mode > BlockHeader::Ans ||
+                (header.Mode == BlockHeader::Ans && header.EncodedSize > MaxGatheredSize(header)))
+            {
+                throw std::runtime_error("Stream: Invalid matches block.");
+            }
+
+            part.resize(header.Size);
+            auto output = reinterpret_cast<char*>(part.data());
+
+            if (header.Mode == BlockHeader::Stored)
+            {
+                std::copy(aData, aData + header.Size, output);
+            }
+            else if (header.Mode == BlockHeader::Ans)
+            {
+                DecodeAns(aData, header.EncodedSize, header, part.data());
+            }
+            else
+            {
+                auto table = MakeTable(reinterpret_cast<const BlockHeader::Entry*>(aData), header.TableLength);
+                DecodeAll(table, aData + tableSize, header.EncodedSize - tableSize, output, part.size());
+            }
+
+            aData += header.EncodedSize;
+            aSize -= header.EncodedSize;
+        }
+
+        if (aSize || !Lz::Unfold(aSequences, aOutput, aBlockSize))
+        {
+            throw std::runtime_error("Stream: Invalid matches block.");
+        }
+    }
+
+    Decoder::Decoder(Budget::Tracker* aMemory)
+      : mMemory{aMemory}
+    {
+    }
+
+    bool Decoder::Finished() const
+    {
+        return mState == State::Finished;
+    }
+
+    bool Decoder::Stage(const char* aData, size_t aSize, size_t& aConsumed, size_t aNeed)
+    {
+        auto count = std::min(aNeed - mStaged, aSize - aConsumed);
+        std::memcpy(mStaging + mStaged, aData + aConsumed, count);
+
+        mStaged += count;
+        aConsumed += count;
+
+        if (mStaged < aNeed)
+        {
+            return false;
+        }
+
+        mStaged = 0;
+        return true;
+    }
+
+    void Decoder::StartBlock()
+    {
+        if (mBlock.Size == 0)
+        {
+            mState = State::Finished;
+            return;
+        }
+
+        if (mBlock.Size > mStream.BlockSize)
+        {
+            throw std::runtime_error("Stream: Block is too large.");
+        }
+
+        mLeft = mBlock.Size;
+        mEncodedLeft = mBlock.EncodedSize;
+
+        if (mBlock.Transform > BlockHeader::Bwt)
+        {
+            throw std::runtime_error("Stream: Unknown block transform.");
+        }
+
+        if (mBlock.Transform && (mBlock.Mode != BlockHeader::Huffman ||
+                                 mBlock.EncodedSize < mBlock.TableLength * sizeof(BlockHeader::Entry) +
+                                                          sizeof(BlockHeader::Transformed)))
+        {
+            throw std::runtime_error("Stream: Invalid block.");
+        }
+
+        switch (mBlock.Mode)
+        {
+        case BlockHeader::Stored:
+            if (mBlock.EncodedSize != mBlock.Size)
+            {
+                throw std::runtime_error("Stream: Invalid block.");
+            }
+            mState = State::Data;
+            break;
+
+        case BlockHeader::Huffman:
+            if (mBlock.TableLength == 0 || mBlock.TableLength > 256 ||
+                mBlock.EncodedSize < mBlock.TableLength * sizeof(BlockHeader::Entry))
+            {
+                throw std::runtime_error("Stream: Invalid block.");
+            }
+            mEncodedLeft -= mBlock.TableLength * sizeof(BlockHeader::Entry);
+            mState = State::Table;
+            break;
+
+        case BlockHeader::Repeat:
+            if (mBlock.TableLength || mBlock.Transform || !mTableReady)
+            {
+                throw std::runtime_error("Stream: Invalid block.");
+            }
+            mDecoder.Reset();
+            mState = State::Data;
+            break;
+
+        case BlockHeader::Lz:
+        case BlockHeader::Ans:
+            if ((mBlock.Mode == BlockHeader::Lz) != (mBlock.TableLength == 0) ||
+                mBlock.EncodedSize > MaxGatheredSize(mBlock))
+            {
+                throw std::runtime_error("Stream: Invalid block.");
+            }
+
+            // Parts of matches block take up to its size each.
+            Reserve(mBlock.EncodedSize + Ans::Slack +
+                    (mBlock.Mode == BlockHeader::Lz ? Lz::Sequences::Count * size_t{mBlock.Size} : 0));
+            mGathered.resize(mBlock.EncodedSize + Ans::Slack);
+            mGatheredSize = 0;
+            mState = State::Gather;
+            break;
+
+        default:
+            throw std::runtime_error("Stream: Unknown block mode.");
+        }
+    }
+
+    void Decoder::StartData()
+    {
+        mTable = MakeTable(reinterpret_cast<const BlockHeader::Entry*>(mStaging), mBlock.TableLength);
+        mTableReady = true;
+        mDecoder.Reset();
+
+        mState = mBlock.Transform ? State::Transformed : State::Data;
+    }
+
+    // Packed data takes up to two bytes per byte of block.
+    void Decoder::StartTransformed()
+    {
+        std::memcpy(&mTransformed, mStaging, sizeof(mTransformed));
+
+        if (mTransformed.Length > 2 * uint64_t{mBlock.Size} || mTransformed.Primary == 0 ||
+            mTransformed.Primary > mBlock.Size)
+        {
+            throw std::runtime_error("Stream: Invalid transformed block.");
+        }
+
+        mEncodedLeft -= sizeof(mTransformed);
+        mLeft = mTransformed.Length;
+
+        mPacked.resize(mTransformed.Length);
+        mPackedSize = 0;
+
+        mState = State::Data;
+    }
+
+    void Decoder::Restore()
+    {
+        mSorted.resize(mBlock.Size);
+        mPlain.resize(mBlock.Size);
+
+        if (!Transform::Unpack(mPacked.data(), mPacked.size(), mSorted.data(), mSorted.size()))
+        {
+            throw std::runtime_error("Stream: Invalid transformed block.");
+        }
+
+        Transform::Inverse(mSorted.data(), mSorted.size(), mTransformed.Primary, mPlain.data());
+        mDrained = 0;
+
+        mState = State::Drain;
+    }
+
+    void Decoder::DecodeGathered()
+    {
+        const auto data = reinterpret_cast<const char*>(mGathered.data());
+
+        if (mBlock.Mode == BlockHeader::Lz)
+        {
+            mPlain.resize(mBlock.Size + Lz::Slack);
+            UnfoldMatches(data, mBlock.EncodedSize, mBlock.Size, mSequences, mPlain.data());
+        }
+        else
+        {
+            mPlain.resize(mBlock.Size);
+            DecodeAns(data, mBlock.EncodedSize, mBlock, mPlain.data());
+        }
+        mDrained = 0;
+
+        mState = State::Drain;
+    }
+
+    // Lease grows with gathered blocks, as buffers keep their memory.
+    void Decoder::Reserve(size_t aSize)
+    {
+        if (aSize > mReserved)
+        {
+            mReserve.Release();
+            mReserve = Budget::Lease{mMemory, aSize};
+            mReserved = aSize;
+        }
+    }
+
+    Decoder::Result Decoder::Feed(const char* aData, size_t aSize, char* aOutput, size_t aCapacity)
+    {
+        size_t consumed = 0;
+        size_t produced = 0;
+
+        for (;;)
+        {
+            switch (mState)
+            {
+            case State::StreamHeader:
+                if (!Stage(aData, aSize, consumed, sizeof(StreamHeader)))
+                {
+                    return Result{consumed, produced};
+                }
+
+                std::memcpy(&mStream, mStaging, sizeof(StreamHeader));
+                if (mStream.Magic != StreamHeader::Signature)
+                {
+                    throw std::runtime_error("Stream: Not a stream.");
+                }
+
+                mLease = Budget::Lease{mMemory, DecoderFootprint(mStream.BlockSize)};
+                mState = State::BlockHeader;
+                break;
+
+            case State::BlockHeader:
+                if (!Stage(aData, aSize, consumed, sizeof(BlockHeader)))
+                {
+                    return Result{consumed, produced};
+                }
+
+                std::memcpy(&mBlock, mStaging, sizeof(BlockHeader));
+                StartBlock();
+                break;
+
+            case State::Table:
+                if (!Stage(aData, aSize, consumed, mBlock.TableLength * sizeof(BlockHeader::Entry)))
+                {
+                    return Result{consumed, produced};
+                }
+
+                StartData();
+                break;
+
+            case State::Transformed:
+                if (!Stage(aData, aSize, consumed, sizeof(BlockHeader::Transformed)))
+                {
+                    return Result{consumed, produced};
+                }
+
+                StartTransformed();
+                break;
+
+            case State::Data:
+            {
+                // Transformed block is decoded to its own buffer.
+                const bool transformed = mBlock.Transform == BlockHeader::Bwt;
+
+                auto output = transformed ? reinterpret_cast<char*>(mPacked.data()) : aOutput;
+                auto capacity = transformed ? mPacked.size() : aCapacity;
+                auto& filled = transformed ? mPackedSize : produced;
+
+                auto available = std::min(aSize - consumed, mEncodedLeft);
+                auto room = std::min(capacity - filled, mLeft);
+
+                if (mBlock.Mode == BlockHeader::Stored)
+                {
+                    auto count = std::min(available, room);
+                    std::memcpy(aOutput + produced, aData + consumed, count);
+
+                    consumed += count;
+                    produced += count;
+                    mEncodedLeft -= count;
+                    mLeft -= count;
+                }
+                else
+                {
+                    auto final = available == mEncodedLeft;
+
+                    BufferSink sink{output, capacity, filled};
+                    auto result = mDecoder.Decode(aData + consumed, available, room, final, sink);
+
+                    consumed += result.Consumed;
+                    filled += result.Produced;
+                    mEncodedLeft -= result.Consumed;
+                    mLeft -= result.Produced;
+
+                    if (mLeft && final && result.Produced < room)
+                    {
+                        throw std::runtime_error("Stream: Block is truncated.");
+                    }
+                }
+
+                if (mLeft)
+                {
+                    // Either input is over or output is full.
+                    return Result{consumed, produced};
+                }
+
+                if (transformed)
+                {
+                    Restore();
+                    break;
+                }
+
+                mState = State::Padding;
+                break;
+            }
+
+            case State::Gather:
+            {
+                auto count = std::min(aSize - consumed, mEncodedLeft);
+                std::memcpy(mGathered.data() + mGatheredSize, aData + consumed, count);
+
+                consumed += count;
+                mGatheredSize += count;
+                mEncodedLeft -= count;
+
+                if (mEncodedLeft)
+                {
+                    return Result{consumed, produced};
+                }
+
+                DecodeGathered();
+                break;
+            }
+
+            case State::Drain:
+            {
+                auto count = std::min(aCapacity - produced, mBlock.Size - mDrained);
+                std::memcpy(aOutput + produced, mPlain.data() + mDrained, count);
+
+                produced += count;
+                mDrained += count;
+
+                if (mDrained < mBlock.Size)
+                {
+                    return Result{consumed, produced};
+                }
+
+                mState = State::Padding;
+                break;
+            }
+
+            case State::Padding:
+            {
+                auto count = std::min(aSize - consumed, mEncodedLeft);
+
+                consumed += count;
+                mEncodedLeft -= count;
+
+                if (mEncodedLeft)
+                {
+                    return Result{consumed, produced};
+                }
+
+                mDecoder.Reset();
+                mState = State::BlockHeader;
+                break;
+            }
+
+            case State::Finished:
+                return Result{consumed, produced};
+            }
+        }
+    }
+
+    std::vector<Block> Index(IStorage::Input& aInput)
+    {
+        const uint64_t size = aInput.Size();
+
+        StreamHeader stream;
+        if (aInput.ReadAt(0, reinterpret_cast<char*>(&stream), sizeof(stream)) != sizeof(stream) ||
+            stream.Magic != StreamHeader::Signature)
+        {
+            throw std::runtime_error("Stream: Not a stream.");
+        }
+
+        std::vector<Block> blocks;
+
+        uint64_t offset = sizeof(stream);
+        uint64_t position = 0;
+
+        // Offset of the last block with a table, if any.
+        uint64_t table = 0;
+
+        for (;;)
+        {
+            Block block{offset, position, BlockHeader{}, offset};
+            if (aInput.ReadAt(offset, reinterpret_cast<char*>(&block.Header), sizeof(BlockHeader)) != sizeof(BlockHeader))
+            {
+                throw std::runtime_error("Stream: Stream is truncated.");
+            }
+
+            const auto& header = block.Header;
+            if (header.Size == 0)
+            {
+                return blocks;
+            }
+
+            offset += sizeof(BlockHeader);
+
+            if (header.Size > stream.BlockSize || header.EncodedSize > size - offset ||
+                (header.Mode == BlockHeader::Stored && header.EncodedSize != header.Size) ||
+                (header.Mode == BlockHeader::Huffman &&
+                 (header.TableLength == 0 || header.TableLength > 256 ||
+                  header.EncodedSize < header.TableLength * sizeof(BlockHeader::Entry))) ||
+                (header.Mode == BlockHeader::Lz && (header.TableLength || header.EncodedSize > MaxGatheredSize(header))) ||
+                (header.Mode == BlockHeader::Ans &&
+                 (header.TableLength == 0 || header.TableLength > 256 ||
+                  header.EncodedSize < header.TableLength * sizeof(BlockHeader::Weight) + sizeof(BlockHeader::Final) ||
+                  header.EncodedSize > MaxGatheredSize(header))) ||
+                (header.Mode == BlockHeader::Repeat && (header.TableLength || header.Transform || !table)) ||
+                header.Mode > BlockHeader::Repeat ||
+                header.Transform > BlockHeader::Bwt ||
+                (header.Transform && (header.Mode != BlockHeader::Huffman ||
+                                      header.EncodedSize < header.TableLength * sizeof(BlockHeader::Entry) +
+                                                               sizeof(BlockHeader::Transformed))))
+            {
+                throw std::runtime_error("Stream: Invalid block.");
+            }
+
+            if (header.Mode == BlockHeader::Huffman)
+            {
+                table = block.Offset;
+            }
+            else if (header.Mode == BlockHeader::Repeat)
+            {
+                block.TableOffset = table;
+            }
+
+            blocks.push_back(block);
+
+            offset += header.EncodedSize;
+            position += header.Size;
+        }
+    }
+
+    void DecodeBlock(IStorage::Input& aInput, const Block& aBlock, char* aOutput)
+    {
+        const auto& header = aBlock.Header;
+        const auto offset = aBlock.Offset + sizeof(BlockHeader);
+
+        if (header.Mode == BlockHeader::Stored)
+        {
+            if (aInput.ReadAt(offset, aOutput, header.Size) != header.Size)
+            {
+                throw std::runtime_error("Stream: Block is truncated.");
+            }
+            return;
+        }
+
+        std::unique_ptr<char[]> data{new char[header.EncodedSize + Ans::Slack]()};
+        if (aInput.ReadAt(offset, data.get(), header.EncodedSize) != header.EncodedSize)
+        {
+            throw std::runtime_error("Stream: Block is truncated.");
+        }
+
+        if (header.Mode == BlockHeader::Lz)
+        {
+            Lz::Sequences sequences;
+            Transform::TBytes plain(header.Size + Lz::Slack);
+
+            UnfoldMatches(data.get(), header.EncodedSize, header.Size, sequences, plain.data());
+            std::memcpy(aOutput, plain.data(), header.Size);
+            return;
+        }
+
+        if (header.Mode == BlockHeader::Ans)
+        {
+            DecodeAns(data.get(), header.EncodedSize, header, reinterpret_cast<uint8_t*>(aOutput));
+            return;
+        }
+
+        if (header.Mode == BlockHeader::Repeat)
+        {
+            BlockHeader owner;
+            if (aInput.ReadAt(aBlock.TableOffset, reinterpret_cast<char*>(&owner), sizeof(owner)) != sizeof(owner) ||
+                owner.Mode != BlockHeader::Huffman || owner.TableLength == 0 || owner.TableLength > 256)
+            {
+                throw std::runtime_error("Stream: Invalid block.");
+            }
+
+            const auto size = owner.TableLength * sizeof(BlockHeader::Entry);
+
+            std::vector<BlockHeader::Entry> entries(owner.TableLength);
+            if (aInput.ReadAt(aBlock.TableOffset + sizeof(owner), reinterpret_cast<char*>(entries.data()), size) != size)
+            {
+                throw std::runtime_error("Stream: Block is truncated.");
+            }
+
+            auto table = MakeTable(entries.data(), entries.size());
+            DecodeAll(table, data.get(), header.EncodedSize, aOutput, header.Size);
+            return;
+        }
+
+        auto tableSize = header.TableLength * sizeof(BlockHeader::Entry);
+        auto table = MakeTable(reinterpret_cast<const BlockHeader::Entry*>(data.get()), header.TableLength);
+
+        BlockHeader::Transformed transformed{0, header.Size};
+        if (header.Transform)
+        {
+            std::memcpy(&transformed, data.get() + tableSize, sizeof(transformed));
+            tableSize += sizeof(transformed);
+
+            if (transformed.Length > 2 * uint64_t{header.Size})
+            {
+                throw std::runtime_error("Stream: Invalid transformed block.");
+            }
+        }
+
+        Transform::TBytes packed(header.Transform ? transformed.Length : 0);
+        auto output = header.Transform ? reinterpret_cast<char*>(packed.data()) : aOutput;
+
+        DecodeAll(table, data.get() + tableSize, header.EncodedSize - tableSize, output, transformed.Length);
+
+        if (header.Transform)
+        {
+            Transform::TBytes sorted(header.Size);
+            if (!Transform::Unpack(packed.data(), packed.size(), sorted.data(), sorted.size()))
+            {
+                throw std::runtime_error("Stream: Invalid transformed block.");
+            }
+
+            Transform::Inverse(sorted.data(), sorted.size(), transformed.Primary, reinterpret_cast<uint8_t*>(aOutput));
+        }
+    }
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Ans.hpp"
+#include "BitsWriter.hpp"
+#include "Budget.hpp"
+#include "DecodeTable.hpp"
+#include "FlatTree.hpp"
+#include "Interfaces.hpp"
+#include "Lz.hpp"
+#include "Model.hpp"
+#include "Transform.hpp"
+
+namespace Stream
+{
+    // Entropy coder of blocks. Best takes the one, which makes block smaller.
+    enum class Coder
+    {
+        Huffman,
+        Ans,
+        Best
+    };
+
+    struct Options
+    {
+        // Input is coded by blocks of up to given size,
+        // each with its own table.
+        size_t BlockSize{64 * 1024};
+
+        // Blocks, which get smaller with Burrows-Wheeler transform,
+        // move-to-front and zero runs packing, are coded transformed.
+        bool Transform{false};
+
+        // Blocks, which get smaller as literals and matches of earlier
+        // data (LZ77), are coded so if these options are given.
+        const Lz::Options* Matches{nullptr};
+
+        // Transformed blocks are always coded with Huffman codes.
+        Coder Entropy{Coder::Huffman};
+
+        // Full block is split into smaller ones, where data changes so
+        // much that tables of their own pay for themselves.
+        bool Split{false};
+    };
+
+    // Bytes which encoder of given options, or decoder of stream of given
+    // block size, takes at most, roughly.
+    size_t EncoderFootprint(const Options& aOptions);
+    size_t DecoderFootprint(size_t aBlockSize);
+
+    struct Coding;
+
+    // Push based encoder. Keeps no more than one block of input, which
+    // goes to output as soon as it is full or flushed.
+    class Encoder
+    {
+    public:
+        explicit Encoder(IStorage::Output& aOutput, const Options& aOptions = Options{});
+
+        Encoder(const Encoder&) = delete;
+        Encoder& operator=(const Encoder&) = delete;
+
+        void Feed(const char* aData, size_t aSize);
+
+        // Writes all data fed so far as a byte aligned block,
+        // so receiver may decode it without waiting for more.
+        void Flush();
+
+        // Flushes and ends the stream, no data may be fed after it.
+        void Finish();
+
+    private:
+        void Start();
+        void WriteBlock();
+        void Code(const Model::TSymbol* aData, size_t aSize);
+        void WritePart(const Model::TSymbol* aData, size_t aSize, const Coding& aCoding);
+
+    private:
+        IStorage::Output& mOutput;
+        Helpers::BitsWriter mBits;
+
+        size_t mBlockSize;
+        std::unique_ptr<char[]> mBlock;
+        size_t mTaken{0};
+
+        bool mTransform;
+        Transform::TBytes mSorted;
+        Transform::TBytes mPacked;
+
+        Coder mEntropy;
+        bool mSplit;
+
+        bool mMatch;
+        Lz::Options mMatches;
+        Lz::Sequences mSequences;
+
+        Huffman::FlatTreeBuilder mBuilder;
+
+        // Codes of the last block with a table, which the next ones may repeat.
+        Kernels::CodeTable mPrevious;
+        bool mRepeatable{false};
+
+        bool mStarted{false};
+        bool mFinished{false};
+    };
+
+    // Push based decoder. Input may be split at any byte, state of headers
+    // and codes is kept between calls. Decoded data goes to caller's buffer,
+    // input which isn't consumed because buffer is full has to be fed again.
+    class Decoder
+    {
+    public:
+        struct Result
+        {
+            size_t Consumed;
+            size_t Produced;
+        };
+
+        Decoder() = default;
+
+        // Memory of stream blocks is taken from tracker, as soon as stream
+        // header gives their size. Stream of too large blocks is refused.
+        explicit Decoder(Budget::Tracker* aMemory);
+
+        Decoder(const Decoder&) = delete;
+        Decoder& operator=(const Decoder&) = delete;
+
+        Result Feed(const char* aData, size_t aSize, char* aOutput, size_t aCapacity);
+
+        // End of stream is reached, the rest of input isn't consumed.
+        bool Finished() const;
+
+    private:
+        enum class State
+        {
+            StreamHeader,
+            BlockHeader,
+            Table,
+            Transformed,
+            Data,
+            Gather,
+            Drain,
+            Padding,
+            Finished
+        };
+
+        bool Stage(const char* aData, size_t aSize, size_t& aConsumed, size_t aNeed);
+
+        void StartBlock();
+        void StartData();
+        void StartTransformed();
+        void Restore();
+        void DecodeGathered();
+        void Reserve(size_t aSize);
+
+    private:
+        State mState{State::StreamHeader};
+
+        Budget::Tracker* mMemory{nullptr};
+        Budget::Lease mLease;
+
+        // Headers and tables are collected here, as they may come in parts.
+        char mStaging[256 * sizeof(Model::BlockHeader::Entry)];
+        size_t mStaged{0};
+
+        Model::StreamHeader mStream{};
+        Model::BlockHeader mBlock{};
+
+        // Encoded bytes and symbols left in current block.
+        size_t mEncodedLeft{0};
+        size_t mLeft{0};
+
+        Helpers::DecodeTable mTable;
+        Helpers::SymbolsDecoder mDecoder{mTable};
+
+        // Table is kept for Repeat blocks, which don't rebuild it.
+        bool mTableReady{false};
+
+        // Transformed block is decoded here first, then turned back and
+        // drained to caller.
+        Model::BlockHeader::Transformed mTransformed{};
+        Transform::TBytes mPacked;
+        size_t mPackedSize{0};
+        Transform::TBytes mSorted;
+        Transform::TBytes mPlain;
+        size_t mDrained{0};
+
+        // Lz and Ans blocks are gathered whole, as parts of the former follow
+        // each other and the latter is decoded from its end.
+        Transform::TBytes mGathered;
+        size_t mGatheredSize{0};
+        Lz::Sequences mSequences;
+
+        // Gathered blocks take memory beyond blocks of stream, as much as
+        // the largest of them, which their buffers keep.
+        Budget::Lease mReserve;
+        size_t mReserved{0};
+    };
+
+    // Place of one block in stream and of its data in decoded one. Table
+    // of Repeat block is found at offset of the block, which it repeats.
+    struct Block
+    {
+        uint64_t Offset;
+        uint64_t Position;
+        Model::BlockHeader Header;
+        uint64_t TableOffset;
+    };
+
+    // Finds all blocks of finished stream from their headers alone.
+    std::vector<Block> Index(IStorage::Input& aInput);
+
+    // Decodes one block into aOutput of Header.Size bytes. Takes
+    // nothing but ReadAt() of input, so it is safe from many threads.
+    void DecodeBlock(IStorage::Input& aInput, const Block& aBlock, char* aOutput);
+}
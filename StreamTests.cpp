@@ -0,0 +1,601 @@
+#include <cstring>
+
+#include "DecodeTable.hpp"
+#include "Memory.hpp"
+#include "Split.hpp"
+#include "Stream.hpp"
+#include "TestsBase.hpp"
+
+using Model::BlockHeader;
+using Model::StreamHeader;
+
+namespace
+{
+    struct Block
+    {
+        BlockHeader Header;
+        std::string Data;
+    };
+
+    struct StringSink
+    {
+        char* Reserve(size_t aSize)
+        {
+            Data.resize(Size + aSize);
+            return &Data[Size];
+        }
+
+        void Commit(size_t aCount)
+        {
+            Size += aCount;
+            Data.resize(Size);
+        }
+
+        std::string Data;
+        size_t Size{0};
+    };
+
+    // Splits stream into blocks, each of them is decoded alone,
+    // but Repeat ones take codes of the last table.
+    std::vector<Block> Parse(const std::string& aStream)
+    {
+        StreamHeader header;
+        EXPECT_LE(sizeof(header), aStream.size());
+        std::memcpy(&header, aStream.data(), sizeof(header));
+        EXPECT_EQ(uint32_t{StreamHeader::Signature}, header.Magic);
+
+        Huffman::FlatTreeBuilder::TCodes codes{};
+
+        std::vector<Block> blocks;
+        for (auto position = sizeof(header); position + sizeof(BlockHeader) <= aStream.size();)
+        {
+            Block block;
+            std::memcpy(&block.Header, aStream.data() + position, sizeof(BlockHeader));
+            position += sizeof(BlockHeader);
+
+            auto payload = aStream.substr(position, block.Header.EncodedSize);
+            position += block.Header.EncodedSize;
+
+            if (block.Header.Mode == BlockHeader::Stored)
+            {
+                block.Data = payload;
+            }
+            else
+            {
+                std::vector<Model::SymbolInfo> entries;
+
+                if (block.Header.Mode != BlockHeader::Repeat)
+                {
+                    codes = Huffman::FlatTreeBuilder::TCodes{};
+                    for (size_t i = 0; i < block.Header.TableLength; ++i)
+                    {
+                        auto entry = reinterpret_cast<const BlockHeader::Entry*>(payload.data()) + i;
+                        codes[entry->Symbol].Length = entry->Length;
+                    }
+
+                    EXPECT_TRUE(Huffman::AssignCanonical(codes));
+                }
+                for (size_t symbol = 0; symbol < codes.size(); ++symbol)
+                {
+                    if (codes[symbol].Length)
+                    {
+                        entries.push_back(Model::SymbolInfo{static_cast<Model::TSymbol>(symbol), codes[symbol]});
+                    }
+                }
+
+                auto offset = block.Header.TableLength * sizeof(BlockHeader::Entry);
+
+                Helpers::DecodeTable table{entries.data(), entries.data() + entries.size()};
+                Helpers::SymbolsDecoder decoder{table};
+
+                StringSink sink;
+                decoder.Decode(payload.data() + offset, payload.size() - offset, block.Header.Size, true, sink);
+                block.Data = sink.Data;
+            }
+
+            blocks.push_back(block);
+        }
+
+        return blocks;
+    }
+}
+
+TEST(StreamEncoder, ShouldEmitDecodableBlockOnFlush)
+{
+    Memory::Writer writer;
+    Stream::Encoder encoder{writer};
+
+    encoder.Feed("hello, hello, hello", 19);
+    encoder.Flush();
+
+    // Everything fed so far may be decoded, before the stream ends.
+    auto blocks = Parse(writer.Data());
+    ASSERT_EQ(1u, blocks.size());
+    EXPECT_EQ(BlockHeader::Huffman, blocks[0].Header.Mode);
+    EXPECT_EQ("hello, hello, hello", blocks[0].Data);
+
+    encoder.Feed("world", 5);
+    encoder.Finish();
+
+    blocks = Parse(writer.Data());
+    ASSERT_EQ(3u, blocks.size());
+    EXPECT_EQ("world", blocks[1].Data);
+    EXPECT_EQ(0u, blocks[2].Header.Size);
+}
+
+TEST(StreamEncoder, ShouldSplitInputIntoBlocks)
+{
+    Stream::Options options;
+    options.BlockSize = 1000;
+
+    Memory::Writer writer;
+    Stream::Encoder encoder{writer, options};
+
+    std::string source;
+    for (int i = 0; i < 3500; ++i)
+    {
+        source.push_back(static_cast<char>('a' + i % 7 * i % 5));
+    }
+
+    // Chunks don't match blocks.
+    for (size_t offset = 0; offset < source.size(); offset += 333)
+    {
+        encoder.Feed(source.data() + offset, std::min<size_t>(333, source.size() - offset));
+    }
+    encoder.Finish();
+
+    auto blocks = Parse(writer.Data());
+    ASSERT_EQ(5u, blocks.size());
+
+    std::string decoded;
+    for (const auto& block : blocks)
+    {
+        EXPECT_GE(options.BlockSize, block.Header.Size);
+        decoded += block.Data;
+    }
+
+    EXPECT_EQ(source, decoded);
+}
+
+TEST(StreamEncoder, ShouldStoreIncompressibleBlock)
+{
+    std::string source;
+    for (int i = 0; i < 256; ++i)
+    {
+        source.push_back(static_cast<char>(i));
+    }
+
+    Memory::Writer writer;
+    Stream::Encoder encoder{writer};
+
+    encoder.Feed(source.data(), source.size());
+    encoder.Finish();
+
+    auto blocks = Parse(writer.Data());
+    ASSERT_EQ(2u, blocks.size());
+    EXPECT_EQ(BlockHeader::Stored, blocks[0].Header.Mode);
+    EXPECT_EQ(source, blocks[0].Data);
+}
+
+TEST(StreamEncoder, ShouldRefuseDataAfterFinish)
+{
+    Memory::Writer writer;
+    Stream::Encoder encoder{writer};
+    encoder.Finish();
+
+    EXPECT_THROW(encoder.Feed("a", 1), std::logic_error);
+    EXPECT_THROW(encoder.Flush(), std::logic_error);
+}
+
+namespace
+{
+    std::string EncodeStream(const std::string& aSource, size_t aBlockSize, bool aTransform = false,
+                             const Lz::Options* aMatches = nullptr, Stream::Coder aEntropy = Stream::Coder::Huffman)
+    {
+        Stream::Options options;
+        options.BlockSize = aBlockSize;
+        options.Transform = aTransform;
+        options.Matches = aMatches;
+        options.Entropy = aEntropy;
+
+        Memory::Writer writer;
+        Stream::Encoder encoder{writer, options};
+
+        encoder.Feed(aSource.data(), aSource.size());
+        encoder.Finish();
+
+        return writer.Data();
+    }
+
+    // Feeds stream by chunks of given size into output buffer of given capacity.
+    std::string DecodeStream(const std::string& aStream, size_t aChunk, size_t aCapacity)
+    {
+        Stream::Decoder decoder;
+
+        std::string result;
+        std::vector<char> buffer(aCapacity);
+
+        for (size_t offset = 0; offset < aStream.size() && !decoder.Finished();)
+        {
+            auto size = std::min(aChunk, aStream.size() - offset);
+            auto feed = decoder.Feed(aStream.data() + offset, size, buffer.data(), buffer.size());
+
+            result.append(buffer.data(), feed.Produced);
+            offset += feed.Consumed;
+        }
+
+        EXPECT_TRUE(decoder.Finished());
+        return result;
+    }
+
+    std::string MakeSource()
+    {
+        std::string source;
+        for (int i = 0; i < 5000; ++i)
+        {
+            source.push_back(static_cast<char>(i % 11 < 6 ? 'a' + i % 3 : i * 7));
+        }
+        return source;
+    }
+}
+
+TEST(StreamDecoder, ShouldDecodeWholeStreamAtOnce)
+{
+    auto source = MakeSource();
+    auto stream = EncodeStream(source, 1024);
+
+    EXPECT_EQ(source, DecodeStream(stream, stream.size(), source.size()));
+}
+
+TEST(StreamDecoder, ShouldDecodeStreamFedByteByByte)
+{
+    auto source = MakeSource();
+    auto stream = EncodeStream(source, 1024);
+
+    // Headers, tables and codes are split at every byte.
+    EXPECT_EQ(source, DecodeStream(stream, 1, 4096));
+}
+
+TEST(StreamDecoder, ShouldDecodeLowEntropyDataIntoSingleByteOutput)
+{
+    // Short codes make lookup entries of several symbols, which output of
+    // one byte cuts, so the rest of each entry is decoded by next calls.
+    std::string source;
+    for (int i = 0; i < 20000; ++i)
+    {
+        source.push_back(i % 17 ? 'a' : static_cast<char>('b' + i % 3));
+    }
+
+    auto stream = EncodeStream(source, 4096);
+
+    EXPECT_EQ(source, DecodeStream(stream, stream.size(), 1));
+    EXPECT_EQ(source, DecodeStream(stream, 3, 1));
+}
+
+TEST(StreamDecoder, ShouldResumeWhenOutputIsFull)
+{
+    auto source = MakeSource();
+    auto stream = EncodeStream(source, 700);
+
+    EXPECT_EQ(source, DecodeStream(stream, 100, 1));
+    EXPECT_EQ(source, DecodeStream(stream, 7, 3));
+}
+
+TEST(StreamDecoder, ShouldDecodeStoredBlocks)
+{
+    std::string source;
+    for (int i = 0; i < 1000; ++i)
+    {
+        source.push_back(static_cast<char>(i));
+    }
+
+    auto stream = EncodeStream(source, 256);
+
+    EXPECT_EQ(source, DecodeStream(stream, 5, 10));
+}
+
+TEST(StreamDecoder, ShouldStopAtTheEndOfStream)
+{
+    auto stream = EncodeStream("some data", 1024) + "tail";
+
+    Stream::Decoder decoder;
+    char buffer[64];
+
+    auto result = decoder.Feed(stream.data(), stream.size(), buffer, sizeof(buffer));
+
+    EXPECT_TRUE(decoder.Finished());
+    EXPECT_EQ(stream.size() - 4, result.Consumed);
+    EXPECT_EQ("some data", std::string(buffer, result.Produced));
+}
+
+TEST(StreamDecoder, ShouldThrowIfNotAStream)
+{
+    auto stream = EncodeStream("some data", 1024);
+    stream[0] = 'X';
+
+    Stream::Decoder decoder;
+    char buffer[64];
+
+    EXPECT_THROW(decoder.Feed(stream.data(), stream.size(), buffer, sizeof(buffer)), std::runtime_error);
+}
+
+TEST(StreamDecoder, ShouldThrowIfBlockIsLargerThanDeclared)
+{
+    auto stream = EncodeStream("some data", 1024);
+
+    // Shrink block size of stream header.
+    stream[4] = 1;
+    stream[5] = 0;
+
+    Stream::Decoder decoder;
+    char buffer[64];
+
+    EXPECT_THROW(decoder.Feed(stream.data(), stream.size(), buffer, sizeof(buffer)), std::runtime_error);
+}
+
+TEST(StreamDecoder, ShouldThrowIfBlockIsCodedLargerThanItCanBe)
+{
+    StreamHeader streamHeader{StreamHeader::Signature, 1024};
+
+    BlockHeader header{};
+    header.Size = 1;
+    header.EncodedSize = 0xFFFFFFF0;
+    header.TableLength = 1;
+    header.Mode = BlockHeader::Ans;
+
+    std::string stream(reinterpret_cast<const char*>(&streamHeader), sizeof(streamHeader));
+    stream.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    Stream::Decoder decoder;
+    char buffer[64];
+
+    EXPECT_THROW(decoder.Feed(stream.data(), stream.size(), buffer, sizeof(buffer)), std::runtime_error);
+
+    header.Mode = BlockHeader::Lz;
+    header.TableLength = 0;
+    stream.replace(sizeof(streamHeader), sizeof(header), reinterpret_cast<const char*>(&header), sizeof(header));
+
+    Stream::Decoder matches;
+    EXPECT_THROW(matches.Feed(stream.data(), stream.size(), buffer, sizeof(buffer)), std::runtime_error);
+}
+
+TEST(StreamDecoder, ShouldDecodeTransformedBlocks)
+{
+    std::string source;
+    for (int i = 0; source.size() < 20000; ++i)
+    {
+        source += "line " + std::to_string(i % 37) + ": the quick brown fox jumps over the lazy dog\n";
+    }
+
+    auto plain = EncodeStream(source, 4096);
+    auto stream = EncodeStream(source, 4096, true);
+
+    BlockHeader first;
+    std::memcpy(&first, stream.data() + sizeof(StreamHeader), sizeof(first));
+    EXPECT_EQ(BlockHeader::Bwt, first.Transform);
+    EXPECT_LT(stream.size() * 2, plain.size());
+
+    EXPECT_EQ(source, DecodeStream(stream, stream.size(), source.size()));
+    EXPECT_EQ(source, DecodeStream(stream, 1, 3));
+
+    // Blocks are decoded alone as well.
+    Memory::Reader input{stream};
+    auto blocks = Stream::Index(input);
+
+    std::string block(blocks[2].Header.Size, '\0');
+    Stream::DecodeBlock(input, blocks[2], &block[0]);
+    EXPECT_EQ(source.substr(blocks[2].Position, block.size()), block);
+}
+
+TEST(StreamDecoder, ShouldDecodeMatchedBlocks)
+{
+    std::string source;
+    for (int i = 0; source.size() < 20000; ++i)
+    {
+        source += "record " + std::to_string(i % 53) + " of the log, status " + std::to_string(i % 7) + "\n";
+    }
+
+    Lz::Options matches;
+    auto plain = EncodeStream(source, 4096);
+    auto stream = EncodeStream(source, 4096, false, &matches);
+
+    BlockHeader first;
+    std::memcpy(&first, stream.data() + sizeof(StreamHeader), sizeof(first));
+    EXPECT_EQ(BlockHeader::Lz, first.Mode);
+    EXPECT_LT(stream.size() * 2, plain.size());
+
+    EXPECT_EQ(source, DecodeStream(stream, stream.size(), source.size()));
+    EXPECT_EQ(source, DecodeStream(stream, 1, 3));
+
+    Memory::Reader input{stream};
+    auto blocks = Stream::Index(input);
+
+    std::string block(blocks[3].Header.Size, '\0');
+    Stream::DecodeBlock(input, blocks[3], &block[0]);
+    EXPECT_EQ(source.substr(blocks[3].Position, block.size()), block);
+
+    // Damaged part is caught before any of block is given out.
+    stream[sizeof(StreamHeader) + sizeof(BlockHeader) + 1] ^= 0x40;
+    EXPECT_THROW(DecodeStream(stream, stream.size(), source.size()), std::runtime_error);
+}
+
+TEST(StreamDecoder, ShouldDecodeAnsBlocks)
+{
+    std::string source;
+    for (int i = 0; i < 30000; ++i)
+    {
+        source.push_back(i % 9 ? 'a' : static_cast<char>('b' + i % 5));
+    }
+
+    auto plain = EncodeStream(source, 4096);
+    auto stream = EncodeStream(source, 4096, false, nullptr, Stream::Coder::Ans);
+
+    BlockHeader first;
+    std::memcpy(&first, stream.data() + sizeof(StreamHeader), sizeof(first));
+    EXPECT_EQ(BlockHeader::Ans, first.Mode);
+    EXPECT_LT(stream.size() * 3, plain.size() * 2);
+
+    EXPECT_EQ(source, DecodeStream(stream, stream.size(), source.size()));
+    EXPECT_EQ(source, DecodeStream(stream, 1, 3));
+
+    Memory::Reader input{stream};
+    auto blocks = Stream::Index(input);
+
+    std::string block(blocks[5].Header.Size, '\0');
+    Stream::DecodeBlock(input, blocks[5], &block[0]);
+    EXPECT_EQ(source.substr(blocks[5].Position, block.size()), block);
+
+    // Best coder takes Ans here, and Ans for parts of matches blocks.
+    Lz::Options matches;
+    EXPECT_EQ(stream, EncodeStream(source, 4096, false, nullptr, Stream::Coder::Best));
+
+    auto matched = EncodeStream(source, 4096, false, &matches, Stream::Coder::Best);
+    EXPECT_EQ(source, DecodeStream(matched, 7, 100));
+}
+
+TEST(StreamDecoder, ShouldRefuseBlocksOverBudget)
+{
+    auto source = MakeSource();
+    auto stream = EncodeStream(source, 1024);
+
+    std::vector<char> buffer(source.size());
+
+    Budget::Tracker small{Stream::DecoderFootprint(1024) - 1};
+    Stream::Decoder refused{&small};
+    EXPECT_THROW(refused.Feed(stream.data(), stream.size(), buffer.data(), buffer.size()), std::runtime_error);
+
+    // Blocks of stream are given back with decoder.
+    Budget::Tracker tracker{Stream::DecoderFootprint(1024)};
+    {
+        Stream::Decoder decoder{&tracker};
+        auto result = decoder.Feed(stream.data(), stream.size(), buffer.data(), buffer.size());
+
+        EXPECT_TRUE(decoder.Finished());
+        EXPECT_EQ(source, std::string(buffer.data(), result.Produced));
+        EXPECT_EQ(tracker.Limit(), tracker.Used());
+    }
+    EXPECT_EQ(0u, tracker.Used());
+}
+
+TEST(StreamDecoder, ShouldRefuseGatheredBlocksOverBudget)
+{
+    std::string source;
+    for (int i = 0; source.size() < 20000; ++i)
+    {
+        source += "record " + std::to_string(i % 53) + " of the log, status " + std::to_string(i % 7) + "\n";
+    }
+
+    Lz::Options matches;
+    auto stream = EncodeStream(source, 4096, false, &matches);
+
+    std::vector<char> buffer(source.size());
+
+    // Gathered block and its parts don't fit beside blocks of stream.
+    Budget::Tracker small{Stream::DecoderFootprint(4096) + 4096};
+    Stream::Decoder refused{&small};
+    try
+    {
+        refused.Feed(stream.data(), stream.size(), buffer.data(), buffer.size());
+        FAIL();
+    }
+    catch (const std::runtime_error& e)
+    {
+        EXPECT_STREQ("Budget: Memory limit is exceeded.", e.what());
+    }
+
+    Budget::Tracker tracker{Stream::DecoderFootprint(4096) + 7 * 4096};
+    {
+        Stream::Decoder decoder{&tracker};
+        auto result = decoder.Feed(stream.data(), stream.size(), buffer.data(), buffer.size());
+
+        EXPECT_TRUE(decoder.Finished());
+        EXPECT_EQ(source, std::string(buffer.data(), result.Produced));
+        EXPECT_LE(tracker.Peak(), tracker.Limit());
+    }
+    EXPECT_EQ(0u, tracker.Used());
+}
+
+TEST(StreamEncoder, ShouldRepeatPreviousTable)
+{
+    std::string source;
+    for (int i = 0; i < 20000; ++i)
+    {
+        source.push_back(static_cast<char>('a' + i * 7 % 13 % 6));
+    }
+
+    // Tail of other symbols needs a table of its own.
+    source += std::string(2000, 'z') + std::string(2000, 'y');
+
+    auto stream = EncodeStream(source, 2000);
+    auto blocks = Parse(stream);
+
+    ASSERT_EQ(13u, blocks.size());
+    EXPECT_EQ(BlockHeader::Huffman, blocks[0].Header.Mode);
+    EXPECT_EQ(BlockHeader::Repeat, blocks[1].Header.Mode);
+    EXPECT_EQ(0u, blocks[1].Header.TableLength);
+    EXPECT_EQ(BlockHeader::Huffman, blocks[10].Header.Mode);
+
+    std::string decoded;
+    for (const auto& block : blocks)
+    {
+        decoded += block.Data;
+    }
+    EXPECT_EQ(source, decoded);
+
+    EXPECT_EQ(source, DecodeStream(stream, 1, 3));
+
+    // Index finds the table of Repeat block.
+    Memory::Reader input{stream};
+    auto index = Stream::Index(input);
+
+    EXPECT_EQ(index[0].Offset, index[9].TableOffset);
+
+    std::string block(index[9].Header.Size, '\0');
+    Stream::DecodeBlock(input, index[9], &block[0]);
+    EXPECT_EQ(source.substr(index[9].Position, block.size()), block);
+}
+
+TEST(StreamEncoder, ShouldSplitBlocksWhereDataChanges)
+{
+    // Data changes at bound of split windows.
+    std::string source;
+    for (int i = 0; source.size() < 10 * Split::Window; ++i)
+    {
+        source += "line " + std::to_string(i % 100) + "\n";
+    }
+    source.resize(10 * Split::Window);
+    for (int i = 0; i < 24000; ++i)
+    {
+        source.push_back(static_cast<char>(i * 2654435761u >> 24));
+    }
+
+    Stream::Options options;
+    options.BlockSize = 64 * 1024;
+
+    Memory::Writer whole;
+    {
+        Stream::Encoder encoder{whole, options};
+        encoder.Feed(source.data(), source.size());
+        encoder.Finish();
+    }
+
+    options.Split = true;
+
+    Memory::Writer split;
+    {
+        Stream::Encoder encoder{split, options};
+        encoder.Feed(source.data(), source.size());
+        encoder.Finish();
+    }
+
+    // Text gets its own table, binary is stored.
+    Memory::Reader input{split.Data()};
+    auto blocks = Stream::Index(input);
+
+    ASSERT_EQ(2u, blocks.size());
+    EXPECT_EQ(BlockHeader::Huffman, blocks[0].Header.Mode);
+    EXPECT_EQ(BlockHeader::Stored, blocks[1].Header.Mode);
+    EXPECT_LT(split.Data().size(), whole.Data().size());
+
+    EXPECT_EQ(source, DecodeStream(split.Data(), 100, 1000));
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+
 #include "Interfaces.hpp"
 #include "Model.hpp"
 
@@ -23,6 +25,39 @@ namespace Helpers
             mCache[mConsumed++] = aSymbol;
         }
 
+        void Write(const char* aData, size_t aSize)
+        {
+            if (aSize > sizeof(mCache) - mConsumed)
+            {
+                Flush();
+
+                if (aSize >= sizeof(mCache))
+                {
+                    mOutput.Write(aData, aSize);
+                    return;
+                }
+            }
+
+            std::memcpy(mCache + mConsumed, aData, aSize);
+            mConsumed += aSize;
+        }
+
+        // Space for up to aSize symbols, of which Commit() takes given count.
+        char* Reserve(size_t aSize)
+        {
+            if (mConsumed + aSize > sizeof(mCache))
+            {
+                Flush();
+            }
+
+            return mCache + mConsumed;
+        }
+
+        void Commit(size_t aCount)
+        {
+            mConsumed += aCount;
+        }
+
         void Flush()
         {
             if (mConsumed)
@@ -0,0 +1,157 @@
+#include <atomic>
+#include <iomanip>
+
+#include "Trace.hpp"
+
+namespace Trace
+{
+    std::atomic<uint64_t> LastRecorderId{0};
+
+    Recorder::Recorder()
+      : mId{++LastRecorderId}
+      , mStart{TClock::now()}
+    {
+    }
+
+    Recorder::Thread& Recorder::Current()
+    {
+        // Buffer of the last recorder used by this thread.
+        thread_local uint64_t recorder = 0;
+        thread_local Thread* thread = nullptr;
+
+        if (recorder != mId)
+        {
+            std::lock_guard<std::mutex> lock{mMutex};
+
+            mThreads.emplace_back(new Thread{static_cast<unsigned>(mThreads.size() + 1), {}});
+            mThreads.back()->Events.reserve(1024);
+
+            thread = mThreads.back().get();
+            recorder = mId;
+        }
+
+        return *thread;
+    }
+
+    void Recorder::Add(const char* aName, const char* aCategory, TClock::time_point aStart, TClock::time_point aEnd)
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::nanoseconds;
+
+        Current().Events.push_back(Event{aName, aCategory, duration_cast<nanoseconds>(aStart - mStart).count(),
+                                         duration_cast<nanoseconds>(aEnd - aStart).count()});
+    }
+
+    size_t Recorder::Count() const
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+
+        size_t count = 0;
+        for (const auto& thread : mThreads)
+        {
+            count += thread->Events.size();
+        }
+        return count;
+    }
+
+    void Recorder::Write(std::ostream& aStream) const
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+
+        const auto flags = aStream.flags();
+        aStream << std::fixed << std::setprecision(3);
+
+        // Timestamps are in microseconds.
+        aStream << "{\"traceEvents\":[";
+
+        auto first = true;
+        for (const auto& thread : mThreads)
+        {
+            for (const auto& event : thread->Events)
+            {
+                aStream << (first ? "\n" : ",\n") << "{\"name\":\"" << event.Name << "\",\"cat\":\""
+                        << event.Category << "\",\"ph\":\"X\",\"ts\":" << event.Start / 1000.0
+                        << ",\"dur\":" << event.Duration / 1000.0 << ",\"pid\":1,\"tid\":" << thread->Id << "}";
+                first = false;
+            }
+        }
+
+        aStream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        aStream.flags(flags);
+    }
+
+    Span::Span(Recorder* aRecorder, const char* aName, const char* aCategory)
+      : mRecorder{aRecorder}
+      , mName{aName}
+      , mCategory{aCategory}
+    {
+        if (mRecorder)
+        {
+            mStart = Recorder::TClock::now();
+        }
+    }
+
+    Span::~Span()
+    {
+        if (mRecorder)
+        {
+            mRecorder->Add(mName, mCategory, mStart, Recorder::TClock::now());
+        }
+    }
+
+    Input::Input(IStorage::Input& aInput, Recorder& aRecorder)
+      : mInput{aInput}
+      , mRecorder{aRecorder}
+    {
+    }
+
+    bool Input::ReadTo(TBuffer* aBuffer)
+    {
+        Span span{&mRecorder, "read", "io"};
+        return mInput.ReadTo(aBuffer);
+    }
+
+    size_t Input::Read(char* aBuffer, size_t aSize)
+    {
+        Span span{&mRecorder, "read", "io"};
+        return mInput.Read(aBuffer, aSize);
+    }
+
+    void Input::Reset()
+    {
+        mInput.Reset();
+    }
+
+    size_t Input::ReadAt(size_t aOffset, char* aBuffer, size_t aSize)
+    {
+        Span span{&mRecorder, "read", "io"};
+        return mInput.ReadAt(aOffset, aBuffer, aSize);
+    }
+
+    size_t Input::Size()
+    {
+        return mInput.Size();
+    }
+
+    Output::Output(IStorage::Output& aOutput, Recorder& aRecorder)
+      : mOutput{aOutput}
+      , mRecorder{aRecorder}
+    {
+    }
+
+    void Output::Write(const char* aBuffer, size_t aSize)
+    {
+        Span span{&mRecorder, "write", "io"};
+        mOutput.Write(aBuffer, aSize);
+    }
+
+    void Output::Skip(const size_t aSize)
+    {
+        mOutput.Skip(aSize);
+    }
+
+    void Output::Reset()
+    {
+        mOutput.Reset();
+    }
+}
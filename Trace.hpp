@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "Interfaces.hpp"
+
+namespace Trace
+{
+    // Collects timestamped spans of all threads. Each thread appends to
+    // its own buffer, so recording takes no lock but the first time.
+    class Recorder
+    {
+    public:
+        using TClock = std::chrono::steady_clock;
+
+        Recorder();
+
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        // Name and category must outlive recorder, e.g. be literals.
+        void Add(const char* aName, const char* aCategory, TClock::time_point aStart, TClock::time_point aEnd);
+
+        size_t Count() const;
+
+        // Chrome trace event format, which trace viewers load.
+        // Must not be called while spans are still recorded.
+        void Write(std::ostream& aStream) const;
+
+    private:
+        struct Event
+        {
+            const char* Name;
+            const char* Category;
+            int64_t Start;
+            int64_t Duration;
+        };
+
+        struct Thread
+        {
+            unsigned Id;
+            std::vector<Event> Events;
+        };
+
+        Thread& Current();
+
+    private:
+        const uint64_t mId;
+        const TClock::time_point mStart;
+
+        mutable std::mutex mMutex;
+        std::vector<std::unique_ptr<Thread>> mThreads;
+    };
+
+    // Records span from construction till destruction.
+    // Does nothing without recorder.
+    class Span
+    {
+    public:
+        Span(Recorder* aRecorder, const char* aName, const char* aCategory);
+        ~Span();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        Recorder* mRecorder;
+        const char* mName;
+        const char* mCategory;
+        Recorder::TClock::time_point mStart;
+    };
+
+    // Records span of each read of given input.
+    struct Input final : IStorage::Input
+    {
+        Input(IStorage::Input& aInput, Recorder& aRecorder);
+
+        virtual bool ReadTo(TBuffer* aBuffer) override;
+        virtual size_t Read(char* aBuffer, size_t aSize) override;
+        virtual void Reset() override;
+        virtual size_t ReadAt(size_t aOffset, char* aBuffer, size_t aSize) override;
+        virtual size_t Size() override;
+
+    private:
+        IStorage::Input& mInput;
+        Recorder& mRecorder;
+    };
+
+    // Records span of each write of given output.
+    struct Output final : IStorage::Output
+    {
+        Output(IStorage::Output& aOutput, Recorder& aRecorder);
+
+        virtual void Write(const char* aBuffer, size_t aSize) override;
+        virtual void Skip(const size_t aSize) override;
+        virtual void Reset() override;
+
+    private:
+        IStorage::Output& mOutput;
+        Recorder& mRecorder;
+    };
+}
@@ -0,0 +1,106 @@
+#include <sstream>
+#include <thread>
+
+#include "Memory.hpp"
+#include "Processor.hpp"
+#include "TestsBase.hpp"
+#include "Trace.hpp"
+
+namespace
+{
+    size_t Occurrences(const std::string& aText, const std::string& aPattern)
+    {
+        size_t count = 0;
+        for (auto position = aText.find(aPattern); position != std::string::npos;
+             position = aText.find(aPattern, position + 1))
+        {
+            count++;
+        }
+        return count;
+    }
+}
+
+TEST(Trace, ShouldDoNothingWithoutRecorder)
+{
+    Trace::Span span{nullptr, "span", "test"};
+}
+
+TEST(Trace, ShouldWriteCompleteEvents)
+{
+    Trace::Recorder recorder;
+    {
+        Trace::Span span{&recorder, "first", "test"};
+    }
+    {
+        Trace::Span span{&recorder, "second", "test"};
+    }
+
+    EXPECT_EQ(2u, recorder.Count());
+
+    std::ostringstream json;
+    recorder.Write(json);
+
+    EXPECT_EQ(0u, json.str().find("{\"traceEvents\":["));
+    EXPECT_EQ(1u, Occurrences(json.str(), "\"name\":\"first\""));
+    EXPECT_EQ(1u, Occurrences(json.str(), "\"name\":\"second\""));
+    EXPECT_EQ(2u, Occurrences(json.str(), "\"ph\":\"X\""));
+}
+
+TEST(Trace, ShouldTellThreadsApart)
+{
+    Trace::Recorder recorder;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; ++i)
+    {
+        threads.emplace_back([&recorder]() {
+            for (int j = 0; j < 100; ++j)
+            {
+                Trace::Span span{&recorder, "work", "test"};
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(300u, recorder.Count());
+
+    std::ostringstream json;
+    recorder.Write(json);
+
+    for (int tid = 1; tid <= 3; ++tid)
+    {
+        EXPECT_EQ(100u, Occurrences(json.str(), "\"tid\":" + std::to_string(tid) + "}"));
+    }
+}
+
+TEST(Trace, ShouldTraceProcessorStagesAndStorage)
+{
+    std::string source(10000, 'a');
+    source += std::string(5000, 'b');
+
+    Trace::Recorder recorder;
+
+    Processor::Config config;
+    config.Trace = &recorder;
+
+    Memory::Reader reader{source};
+    Memory::Writer writer;
+
+    Trace::Input input{reader, recorder};
+    Trace::Output output{writer, recorder};
+
+    Processor::Encode(input, output, config);
+
+    std::ostringstream json;
+    recorder.Write(json);
+
+    EXPECT_EQ(1u, Occurrences(json.str(), "\"name\":\"histogram\""));
+    EXPECT_EQ(1u, Occurrences(json.str(), "\"name\":\"tree\""));
+    EXPECT_LT(0u, Occurrences(json.str(), "\"name\":\"encode\""));
+    EXPECT_LT(0u, Occurrences(json.str(), "\"name\":\"read\""));
+    EXPECT_LT(0u, Occurrences(json.str(), "\"name\":\"write\""));
+}
@@ -0,0 +1,7 @@
+#include "Application.hpp"
+#include "Processor.hpp"
+
+int main(int argc, char** argv)
+{
+    return Application::Run(Processor::Train, argc, argv);
+}
@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "Transform.hpp"
+
+namespace Transform
+{
+    namespace
+    {
+        // Start or end of each character bucket of suffix array.
+        void Buckets(const std::vector<int32_t>& aCounts, int32_t* aBuckets, bool aEnd)
+        {
+            int32_t sum = 0;
+            for (size_t c = 0; c < aCounts.size(); ++c)
+            {
+                sum += aCounts[c];
+                aBuckets[c] = aEnd ? sum : sum - aCounts[c];
+            }
+        }
+
+        void InduceL(const int32_t* aText, const std::vector<uint8_t>& aTypes, int32_t* aSuffixes, size_t aSize,
+                     const std::vector<int32_t>& aCounts, int32_t* aBuckets)
+        {
+            Buckets(aCounts, aBuckets, false);
+            for (size_t i = 0; i < aSize; ++i)
+            {
+                auto j = aSuffixes[i] - 1;
+                if (j >= 0 && !aTypes[j])
+                {
+                    aSuffixes[aBuckets[aText[j]]++] = j;
+                }
+            }
+        }
+
+        void InduceS(const int32_t* aText, const std::vector<uint8_t>& aTypes, int32_t* aSuffixes, size_t aSize,
+                     const std::vector<int32_t>& aCounts, int32_t* aBuckets)
+        {
+            Buckets(aCounts, aBuckets, true);
+            for (size_t i = aSize; i-- > 0;)
+            {
+                auto j = aSuffixes[i] - 1;
+                if (j >= 0 && aTypes[j])
+                {
+                    aSuffixes[--aBuckets[aText[j]]] = j;
+                }
+            }
+        }
+
+        // Text ends with unique smallest character. S-type suffixes are marked
+        // in types, LMS ones are the leftmost of each run of S-type suffixes.
+        void InducedSort(const int32_t* aText, int32_t* aSuffixes, size_t aSize, int32_t aAlphabet)
+        {
+            std::vector<uint8_t> types(aSize);
+            types[aSize - 1] = true;
+            for (size_t i = aSize - 1; i-- > 0;)
+            {
+                types[i] = aText[i] < aText[i + 1] || (aText[i] == aText[i + 1] && types[i + 1]);
+            }
+
+            auto lms = [&types](size_t aIndex) { return aIndex > 0 && types[aIndex] && !types[aIndex - 1]; };
+
+            std::vector<int32_t> counts(aAlphabet);
+            for (size_t i = 0; i < aSize; ++i)
+            {
+                counts[aText[i]]++;
+            }
+
+            std::vector<int32_t> buckets(aAlphabet);
+
+            // Sort LMS substrings by inducing from their unsorted positions.
+            Buckets(counts, buckets.data(), true);
+            std::fill(aSuffixes, aSuffixes + aSize, -1);
+            for (size_t i = 1; i < aSize; ++i)
+            {
+                if (lms(i))
+                {
+                    aSuffixes[--buckets[aText[i]]] = static_cast<int32_t>(i);
+                }
+            }
+
+            InduceL(aText, types, aSuffixes, aSize, counts, buckets.data());
+            InduceS(aText, types, aSuffixes, aSize, counts, buckets.data());
+
+            size_t count = 0;
+            for (size_t i = 0; i < aSize; ++i)
+            {
+                if (lms(aSuffixes[i]))
+                {
+                    aSuffixes[count++] = aSuffixes[i];
+                }
+            }
+
+            // Name LMS substrings, equal ones get the same name. Names are
+            // put at half of position, as LMS positions are two apart at least.
+            std::fill(aSuffixes + count, aSuffixes + aSize, -1);
+
+            int32_t names = 0;
+            int32_t previous = -1;
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto position = aSuffixes[i];
+
+                bool different = false;
+                for (size_t d = 0; d < aSize; ++d)
+                {
+                    if (previous == -1 || aText[position + d] != aText[previous + d] ||
+                        types[position + d] != types[previous + d])
+                    {
+                        different = true;
+                        break;
+                    }
+                    if (d > 0 && (lms(position + d) || lms(previous + d)))
+                    {
+                        break;
+                    }
+                }
+
+                if (different)
+                {
+                    ++names;
+                    previous = position;
+                }
+
+                aSuffixes[count + position / 2] = names - 1;
+            }
+
+            for (size_t i = aSize, j = aSize; i-- > count;)
+            {
+                if (aSuffixes[i] >= 0)
+                {
+                    aSuffixes[--j] = aSuffixes[i];
+                }
+            }
+
+            // Order of LMS suffixes comes from their reduced text,
+            // recursively unless all names are unique.
+            auto reduced = aSuffixes + aSize - count;
+            if (static_cast<size_t>(names) < count)
+            {
+                InducedSort(reduced, aSuffixes, count, names);
+            }
+            else
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    aSuffixes[reduced[i]] = static_cast<int32_t>(i);
+                }
+            }
+
+            for (size_t i = 1, j = 0; i < aSize; ++i)
+            {
+                if (lms(i))
+                {
+                    reduced[j++] = static_cast<int32_t>(i);
+                }
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                aSuffixes[i] = reduced[aSuffixes[i]];
+            }
+
+            // Sorted LMS suffixes induce all the others.
+            Buckets(counts, buckets.data(), true);
+            std::fill(aSuffixes + count, aSuffixes + aSize, -1);
+            for (size_t i = count; i-- > 0;)
+            {
+                auto j = aSuffixes[i];
+                aSuffixes[i] = -1;
+                aSuffixes[--buckets[aText[j]]] = j;
+            }
+
+            InduceL(aText, types, aSuffixes, aSize, counts, buckets.data());
+            InduceS(aText, types, aSuffixes, aSize, counts, buckets.data());
+        }
+    }
+
+    std::vector<int32_t> SuffixArray(const uint8_t* aData, size_t aSize)
+    {
+        if (aSize >= static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+        {
+            throw std::invalid_argument("Transform: Data is too large.");
+        }
+
+        // Bytes are shifted by one to free zero for sentinel.
+        std::vector<int32_t> text(aSize + 1);
+        for (size_t i = 0; i < aSize; ++i)
+        {
+            text[i] = aData[i] + 1;
+        }
+
+        std::vector<int32_t> suffixes(aSize + 1);
+        if (aSize == 0)
+        {
+            suffixes[0] = 0;
+            return suffixes;
+        }
+
+        InducedSort(text.data(), suffixes.data(), text.size(), 257);
+        return suffixes;
+    }
+
+    uint32_t Forward(const uint8_t* aData, size_t aSize, uint8_t* aOutput)
+    {
+        const auto suffixes = SuffixArray(aData, aSize);
+
+        uint32_t primary = 0;
+        for (size_t i = 0; i < suffixes.size(); ++i)
+        {
+            if (suffixes[i] == 0)
+            {
+                primary = static_cast<uint32_t>(i);
+                continue;
+            }
+            *aOutput++ = aData[suffixes[i] - 1];
+        }
+
+        return primary;
+    }
+
+    void Inverse(const uint8_t* aData, size_t aSize, uint32_t aPrimary, uint8_t* aOutput)
+    {
+        if (aPrimary == 0 || aPrimary > aSize)
+        {
+            throw std::runtime_error("Transform: Invalid primary index.");
+        }
+
+        // Row of each character's next occurrence in first column. Sentinel
+        // takes the first row, so rows of bytes start from one.
+        size_t starts[256];
+        size_t counts[256]{};
+        for (size_t i = 0; i < aSize; ++i)
+        {
+            counts[aData[i]]++;
+        }
+
+        size_t sum = 1;
+        for (size_t c = 0; c < 256; ++c)
+        {
+            starts[c] = sum;
+            sum += counts[c];
+        }
+
+        // Last-to-first mapping of rows, row of sentinel is skipped.
+        std::vector<uint32_t> next(aSize + 1);
+        for (size_t row = 0, i = 0; row <= aSize; ++row)
+        {
+            if (row == aPrimary)
+            {
+                continue;
+            }
+            next[row] = static_cast<uint32_t>(starts[aData[i++]]++);
+        }
+
+        // The first row starts with sentinel, so its last column holds the last byte.
+        size_t row = 0;
+        for (size_t i = aSize; i-- > 0;)
+        {
+            auto index = row < aPrimary ? row : row - 1;
+            aOutput[i] = aData[index];
+            row = next[row];
+        }
+    }
+
+    void Pack(const uint8_t* aData, size_t aSize, TBytes& aOutput)
+    {
+        uint8_t order[256];
+        for (size_t c = 0; c < 256; ++c)
+        {
+            order[c] = static_cast<uint8_t>(c);
+        }
+
+        aOutput.clear();
+        aOutput.reserve(aSize);
+
+        size_t run = 0;
+        for (size_t i = 0; i < aSize; ++i)
+        {
+            const auto symbol = aData[i];
+
+            uint8_t rank = 0;
+            while (order[rank] != symbol)
+            {
+                ++rank;
+            }
+
+            if (rank == 0)
+            {
+                if (++run == 256)
+                {
+                    aOutput.push_back(0);
+                    aOutput.push_back(255);
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run)
+            {
+                aOutput.push_back(0);
+                aOutput.push_back(static_cast<uint8_t>(run - 1));
+                run = 0;
+            }
+
+            std::memmove(order + 1, order, rank);
+            order[0] = symbol;
+
+            aOutput.push_back(rank);
+        }
+
+        if (run)
+        {
+            aOutput.push_back(0);
+            aOutput.push_back(static_cast<uint8_t>(run - 1));
+        }
+    }
+
+    bool Unpack(const uint8_t* aData, size_t aSize, uint8_t* aOutput, size_t aOutputSize)
+    {
+        uint8_t order[256];
+        for (size_t c = 0; c < 256; ++c)
+        {
+            order[c] = static_cast<uint8_t>(c);
+        }
+
+        size_t produced = 0;
+        for (size_t i = 0; i < aSize; ++i)
+        {
+            const auto rank = aData[i];
+
+            if (rank == 0)
+            {
+                if (++i == aSize)
+                {
+                    return false;
+                }
+
+                size_t run = aData[i] + size_t{1};
+                if (run > aOutputSize - produced)
+                {
+                    return false;
+                }
+
+                std::memset(aOutput + produced, order[0], run);
+                produced += run;
+                continue;
+            }
+
+            if (produced == aOutputSize)
+            {
+                return false;
+            }
+
+            const auto symbol = order[rank];
+            std::memmove(order + 1, order, rank);
+            order[0] = symbol;
+
+            aOutput[produced++] = symbol;
+        }
+
+        return produced == aOutputSize;
+    }
+}
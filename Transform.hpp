@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Transform
+{
+    using TBytes = std::vector<uint8_t>;
+
+    // Suffix array of data with implicit sentinel at its end, which is
+    // smaller than any byte, so the first entry is always aSize. Built
+    // by induced sorting (SA-IS) in linear time.
+    std::vector<int32_t> SuffixArray(const uint8_t* aData, size_t aSize);
+
+    // Burrows-Wheeler transform. Output is of input size, returned
+    // index is the row of the sentinel, which isn't written.
+    uint32_t Forward(const uint8_t* aData, size_t aSize, uint8_t* aOutput);
+    void Inverse(const uint8_t* aData, size_t aSize, uint32_t aPrimary, uint8_t* aOutput);
+
+    // Move-to-front, then each run of zeros as zero and run length less one.
+    // Runs of BWT output become runs of zeros, which this packs.
+    void Pack(const uint8_t* aData, size_t aSize, TBytes& aOutput);
+
+    // Returns false if data doesn't unpack to exactly aSize bytes.
+    bool Unpack(const uint8_t* aData, size_t aSize, uint8_t* aOutput, size_t aOutputSize);
+}
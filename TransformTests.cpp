@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <random>
+
+#include "TestsBase.hpp"
+#include "Transform.hpp"
+
+namespace
+{
+    Transform::TBytes Bytes(const std::string& aText)
+    {
+        return Transform::TBytes(aText.begin(), aText.end());
+    }
+}
+
+TEST(Transform, ShouldBuildSuffixArray)
+{
+    std::mt19937 random{42};
+
+    for (int i = 0; i < 500; ++i)
+    {
+        Transform::TBytes data(random() % 100);
+        auto alphabet = 1 + random() % 4;
+        for (auto& byte : data)
+        {
+            byte = static_cast<uint8_t>('a' + random() % alphabet);
+        }
+
+        std::vector<int32_t> expected(data.size() + 1);
+        for (size_t j = 0; j < expected.size(); ++j)
+        {
+            expected[j] = static_cast<int32_t>(j);
+        }
+        std::sort(expected.begin(), expected.end(), [&data](int32_t aLeft, int32_t aRight) {
+            return std::lexicographical_compare(data.begin() + aLeft, data.end(), data.begin() + aRight, data.end());
+        });
+
+        ASSERT_EQ(expected, Transform::SuffixArray(data.data(), data.size()));
+    }
+}
+
+TEST(Transform, ShouldTransformAndRestore)
+{
+    auto data = Bytes("banana");
+    Transform::TBytes sorted(data.size());
+
+    // Rows of banana$ with sentinel skipped from last column.
+    auto primary = Transform::Forward(data.data(), data.size(), sorted.data());
+    EXPECT_EQ(Bytes("annbaa"), sorted);
+    EXPECT_EQ(4u, primary);
+
+    Transform::TBytes restored(data.size());
+    Transform::Inverse(sorted.data(), sorted.size(), primary, restored.data());
+    EXPECT_EQ(data, restored);
+
+    EXPECT_THROW(Transform::Inverse(sorted.data(), sorted.size(), 0, restored.data()), std::runtime_error);
+}
+
+TEST(Transform, ShouldPackRunsOfZeros)
+{
+    auto data = Bytes(std::string(300, 'x') + "yx");
+
+    Transform::TBytes packed;
+    Transform::Pack(data.data(), data.size(), packed);
+
+    // First x moves to front, then runs of 256 and 43 zeros.
+    Transform::TBytes expected{'x', 0, 255, 0, 42, 'y', 1};
+    EXPECT_EQ(expected, packed);
+
+    Transform::TBytes unpacked(data.size());
+    EXPECT_TRUE(Transform::Unpack(packed.data(), packed.size(), unpacked.data(), unpacked.size()));
+    EXPECT_EQ(data, unpacked);
+
+    EXPECT_FALSE(Transform::Unpack(packed.data(), packed.size() - 1, unpacked.data(), unpacked.size()));
+    EXPECT_FALSE(Transform::Unpack(packed.data(), packed.size(), unpacked.data(), unpacked.size() - 1));
+}
@@ -0,0 +1,780 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "Uring.hpp"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define URING_SUPPORTED
+#endif
+#endif
+
+#ifdef URING_SUPPORTED
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Uring
+{
+    namespace
+    {
+        std::runtime_error Error(const std::string& aWhat, int aError)
+        {
+            return std::runtime_error("Uring: " + aWhat + ": " + std::strerror(aError));
+        }
+
+        // Page aligned memory, as O_DIRECT requires.
+        struct Buffers
+        {
+            Buffers(size_t aSize)
+              : Size{aSize}
+            {
+                Data = static_cast<char*>(::mmap(nullptr, aSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+                if (Data == MAP_FAILED)
+                {
+                    throw Error("Buffers allocation failed", errno);
+                }
+            }
+
+            ~Buffers()
+            {
+                ::munmap(Data, Size);
+            }
+
+            char* Data{nullptr};
+            size_t Size{0};
+        };
+    }
+
+    struct Completion
+    {
+        uint64_t UserData;
+        int Result;
+    };
+
+    class Ring
+    {
+    public:
+        Ring(unsigned aEntries, size_t aBufferSize)
+          : mBuffers{aBufferSize * aEntries}
+          , mBufferSize{aBufferSize}
+        {
+            if (aEntries == 0 || aBufferSize == 0 || aBufferSize > 0x7FFFF000)
+            {
+                throw std::invalid_argument("Uring: Invalid options.");
+            }
+
+            io_uring_params params{};
+
+            mDescriptor = static_cast<int>(::syscall(__NR_io_uring_setup, aEntries, &params));
+            if (mDescriptor < 0)
+            {
+                throw Error("Setup failed", errno);
+            }
+
+            mSqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            mCqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+            if (params.features & IORING_FEAT_SINGLE_MMAP)
+            {
+                mSqSize = mCqSize = std::max(mSqSize, mCqSize);
+            }
+
+            // Destructor doesn't run if constructor throws.
+            try
+            {
+                mSq = Map(mSqSize, IORING_OFF_SQ_RING);
+                mCq = params.features & IORING_FEAT_SINGLE_MMAP ? mSq : Map(mCqSize, IORING_OFF_CQ_RING);
+
+                mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+                mSqes = static_cast<io_uring_sqe*>(Map(mSqesSize, IORING_OFF_SQES));
+            }
+            catch (...)
+            {
+                Release();
+                throw;
+            }
+
+            auto sq = static_cast<char*>(mSq);
+            mSqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            mSqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            mSqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            mSqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+            auto cq = static_cast<char*>(mCq);
+            mCqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            mCqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            mCqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            mCqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            // Registered buffers save page pinning on every request.
+            // Not fatal if locked memory limit is too low.
+            std::unique_ptr<iovec[]> vectors{new iovec[aEntries]};
+            for (unsigned i = 0; i < aEntries; ++i)
+            {
+                vectors[i].iov_base = Buffer(i);
+                vectors[i].iov_len = aBufferSize;
+            }
+
+            mRegistered = ::syscall(__NR_io_uring_register, mDescriptor, IORING_REGISTER_BUFFERS, vectors.get(), aEntries) == 0;
+        }
+
+        ~Ring()
+        {
+            Release();
+        }
+
+        char* Buffer(unsigned aIndex)
+        {
+            return mBuffers.Data + aIndex * mBufferSize;
+        }
+
+        // Queues request on buffer with given index,
+        // it is passed to kernel on next Enter().
+        void Push(bool aWrite, int aDescriptor, unsigned aIndex, size_t aSize, size_t aOffset)
+        {
+            auto tail = *mSqTail;
+            auto index = tail & mSqMask;
+
+            auto& sqe = mSqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+
+            if (mRegistered)
+            {
+                sqe.opcode = aWrite ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+                sqe.buf_index = static_cast<uint16_t>(aIndex);
+            }
+            else
+            {
+                sqe.opcode = aWrite ? IORING_OP_WRITE : IORING_OP_READ;
+            }
+
+            sqe.fd = aDescriptor;
+            sqe.addr = reinterpret_cast<uint64_t>(Buffer(aIndex));
+            sqe.len = static_cast<uint32_t>(aSize);
+            sqe.off = aOffset;
+            sqe.user_data = aIndex;
+
+            mSqArray[index] = index;
+            __atomic_store_n(mSqTail, tail + 1, __ATOMIC_RELEASE);
+
+            mQueued++;
+        }
+
+        // Submits queued requests and optionally waits for one completion.
+        void Enter(bool aWait)
+        {
+            while (mQueued || aWait)
+            {
+                auto result = ::syscall(__NR_io_uring_enter, mDescriptor, mQueued, aWait ? 1 : 0,
+                                        aWait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                if (result < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw Error("Submission failed", errno);
+                }
+
+                mQueued -= static_cast<unsigned>(result);
+                break;
+            }
+        }
+
+        bool Peek(Completion& aCompletion)
+        {
+            auto head = *mCqHead;
+            if (head == __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE))
+            {
+                return false;
+            }
+
+            const auto& cqe = mCqes[head & mCqMask];
+            aCompletion = Completion{cqe.user_data, cqe.res};
+
+            __atomic_store_n(mCqHead, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        Completion Wait()
+        {
+            Completion completion;
+            while (!Peek(completion))
+            {
+                Enter(true);
+            }
+            return completion;
+        }
+
+    private:
+        // Unmaps rings, which are mapped, and closes ring.
+        void Release()
+        {
+            if (mSqes)
+            {
+                ::munmap(mSqes, mSqesSize);
+            }
+            if (mCq && mCq != mSq)
+            {
+                ::munmap(mCq, mCqSize);
+            }
+            if (mSq)
+            {
+                ::munmap(mSq, mSqSize);
+            }
+            ::close(mDescriptor);
+        }
+
+        void* Map(size_t aSize, off_t aOffset)
+        {
+            auto memory = ::mmap(nullptr, aSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mDescriptor, aOffset);
+            if (memory == MAP_FAILED)
+            {
+                throw Error("Ring mapping failed", errno);
+            }
+            return memory;
+        }
+
+    private:
+        int mDescriptor{-1};
+
+        Buffers mBuffers;
+        size_t mBufferSize;
+        bool mRegistered{false};
+
+        void* mSq{nullptr};
+        void* mCq{nullptr};
+        size_t mSqSize{0};
+        size_t mCqSize{0};
+
+        io_uring_sqe* mSqes{nullptr};
+        size_t mSqesSize{0};
+
+        unsigned* mSqHead{nullptr};
+        unsigned* mSqTail{nullptr};
+        unsigned* mSqArray{nullptr};
+        unsigned mSqMask{0};
+
+        unsigned* mCqHead{nullptr};
+        unsigned* mCqTail{nullptr};
+        unsigned mCqMask{0};
+        io_uring_cqe* mCqes{nullptr};
+
+        unsigned mQueued{0};
+    };
+
+    bool Available()
+    {
+        static const bool available = []() {
+            io_uring_params params{};
+
+            auto descriptor = ::syscall(__NR_io_uring_setup, 1, &params);
+            if (descriptor < 0)
+            {
+                return false;
+            }
+
+            ::close(static_cast<int>(descriptor));
+            return true;
+        }();
+
+        return available;
+    }
+
+    struct Reader::Slot
+    {
+        char* Data{nullptr};
+        size_t Offset{0};
+        size_t Size{0};
+        bool Pending{false};
+    };
+
+    Reader::Reader(const std::string& aName, const Options& aOptions)
+      : mOptions{aOptions}
+    {
+        if (mOptions.Direct)
+        {
+            mDescriptor = ::open(aName.c_str(), O_RDONLY | O_DIRECT);
+        }
+
+        // File system may not support O_DIRECT.
+        mRandomAccessDescriptor = ::open(aName.c_str(), O_RDONLY);
+        if (mRandomAccessDescriptor < 0)
+        {
+            auto error = errno;
+            if (mDescriptor >= 0)
+            {
+                ::close(mDescriptor);
+            }
+            throw Error("Can't open " + aName, error);
+        }
+
+        if (mDescriptor < 0)
+        {
+            mDescriptor = mRandomAccessDescriptor;
+        }
+
+        struct stat info;
+        if (::fstat(mRandomAccessDescriptor, &info) == 0)
+        {
+            mSize = static_cast<size_t>(info.st_size);
+        }
+
+        // Destructor doesn't run for reader, which fails to start.
+        try
+        {
+            mRing.reset(new Ring{mOptions.Depth, mOptions.BlockSize});
+            mSlots.reset(new Slot[mOptions.Depth]);
+
+            for (unsigned i = 0; i < mOptions.Depth; ++i)
+            {
+                mSlots[i].Data = mRing->Buffer(i);
+            }
+
+            Reset();
+        }
+        catch (...)
+        {
+            mRing.reset();
+            if (mDescriptor != mRandomAccessDescriptor)
+            {
+                ::close(mDescriptor);
+            }
+            ::close(mRandomAccessDescriptor);
+            throw;
+        }
+    }
+
+    Reader::~Reader()
+    {
+        try
+        {
+            Drain();
+        }
+        catch (...)
+        {
+        }
+
+        mRing.reset();
+
+        if (mDescriptor != mRandomAccessDescriptor)
+        {
+            ::close(mDescriptor);
+        }
+        ::close(mRandomAccessDescriptor);
+    }
+
+    void Reader::Submit(Slot& aSlot)
+    {
+        aSlot.Offset = mNextOffset;
+        aSlot.Size = 0;
+        aSlot.Pending = false;
+
+        if (mNextOffset >= mSize)
+        {
+            return;
+        }
+
+        aSlot.Pending = true;
+        mRing->Push(false, mDescriptor, static_cast<unsigned>(&aSlot - mSlots.get()), mOptions.BlockSize, mNextOffset);
+
+        mNextOffset += mOptions.BlockSize;
+    }
+
+    Reader::Slot* Reader::Current()
+    {
+        auto& slot = mSlots[mCurrent];
+
+        while (slot.Pending)
+        {
+            auto completion = mRing->Wait();
+            auto& done = mSlots[completion.UserData];
+
+            if (completion.Result < 0)
+            {
+                done.Pending = false;
+                throw Error("Reading failed", -completion.Result);
+            }
+
+            done.Size = static_cast<size_t>(completion.Result);
+            done.Pending = false;
+
+            // Short read before end of file, rest is read synchronously.
+            auto expected = std::min(mOptions.BlockSize, mSize - done.Offset);
+            if (done.Size < expected)
+            {
+                done.Size += ReadAt(done.Offset + done.Size, done.Data + done.Size, expected - done.Size);
+            }
+        }
+
+        if (mPosition == slot.Size)
+        {
+            return nullptr;
+        }
+
+        return &slot;
+    }
+
+    void Reader::Drain()
+    {
+        mRing->Enter(false);
+
+        for (unsigned i = 0; i < mOptions.Depth; ++i)
+        {
+            while (mSlots[i].Pending)
+            {
+                mSlots[mRing->Wait().UserData].Pending = false;
+            }
+        }
+    }
+
+    bool Reader::ReadTo(TBuffer* aBuffer)
+    {
+        auto slot = Current();
+        if (!slot)
+        {
+            aBuffer->clear();
+            return false;
+        }
+
+        aBuffer->assign(slot->Data + mPosition, slot->Data + slot->Size);
+        mPosition = slot->Size;
+
+        // Refill consumed buffer, next one is probably ready already.
+        Submit(*slot);
+        mRing->Enter(false);
+
+        mCurrent = (mCurrent + 1) % mOptions.Depth;
+        mPosition = 0;
+
+        return true;
+    }
+
+    size_t Reader::Read(char* aBuffer, size_t aSize)
+    {
+        size_t count = 0;
+
+        while (count < aSize)
+        {
+            auto slot = Current();
+            if (!slot)
+            {
+                break;
+            }
+
+            auto size = std::min(aSize - count, slot->Size - mPosition);
+            std::memcpy(aBuffer + count, slot->Data + mPosition, size);
+
+            count += size;
+            mPosition += size;
+
+            if (mPosition == slot->Size)
+            {
+                Submit(*slot);
+                mRing->Enter(false);
+
+                mCurrent = (mCurrent + 1) % mOptions.Depth;
+                mPosition = 0;
+            }
+        }
+
+        return count;
+    }
+
+    void Reader::Reset()
+    {
+        Drain();
+
+        mNextOffset = 0;
+        mCurrent = 0;
+        mPosition = 0;
+
+        for (unsigned i = 0; i < mOptions.Depth; ++i)
+        {
+            Submit(mSlots[i]);
+        }
+
+        mRing->Enter(false);
+    }
+
+    size_t Reader::ReadAt(size_t aOffset, char* aBuffer, size_t aSize)
+    {
+        size_t count = 0;
+        while (count < aSize)
+        {
+            auto result = ::pread(mRandomAccessDescriptor, aBuffer + count, aSize - count, aOffset + count);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                break;
+            }
+            count += result;
+        }
+        return count;
+    }
+
+    size_t Reader::Size()
+    {
+        return mSize;
+    }
+
+    struct Writer::Slot
+    {
+        char* Data{nullptr};
+        size_t Offset{0};
+        size_t Size{0};
+        bool Pending{false};
+    };
+
+    Writer::Writer(const std::string& aName, const Options& aOptions)
+      : mOptions{aOptions}
+    {
+        mDescriptor = ::open(aName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (mDescriptor < 0)
+        {
+            throw Error("Can't open " + aName, errno);
+        }
+
+        try
+        {
+            mRing.reset(new Ring{mOptions.Depth, mOptions.BlockSize});
+            mSlots.reset(new Slot[mOptions.Depth]);
+        }
+        catch (...)
+        {
+            ::close(mDescriptor);
+            throw;
+        }
+
+        for (unsigned i = 0; i < mOptions.Depth; ++i)
+        {
+            mSlots[i].Data = mRing->Buffer(i);
+        }
+    }
+
+    Writer::~Writer()
+    {
+        try
+        {
+            Close();
+        }
+        catch (...)
+        {
+        }
+
+        mRing.reset();
+        ::close(mDescriptor);
+    }
+
+    void Writer::Write(const char* aBuffer, size_t aSize)
+    {
+        while (aSize > 0)
+        {
+            auto& slot = mSlots[mCurrent];
+
+            auto size = std::min(aSize, mOptions.BlockSize - slot.Size);
+            std::memcpy(slot.Data + slot.Size, aBuffer, size);
+
+            slot.Size += size;
+            aBuffer += size;
+            aSize -= size;
+
+            if (slot.Size == mOptions.BlockSize)
+            {
+                Submit();
+            }
+        }
+    }
+
+    void Writer::Skip(const size_t aSize)
+    {
+        Submit();
+        mOffset += aSize;
+    }
+
+    void Writer::Reset()
+    {
+        // Requests in flight may overlap with whatever comes next.
+        Submit();
+        Drain();
+
+        mOffset = 0;
+    }
+
+    void Writer::Close()
+    {
+        Submit();
+        Drain();
+    }
+
+    void Writer::Submit()
+    {
+        auto& slot = mSlots[mCurrent];
+        if (!slot.Size)
+        {
+            return;
+        }
+
+        slot.Offset = mOffset;
+        slot.Pending = true;
+        mRing->Push(true, mDescriptor, static_cast<unsigned>(mCurrent), slot.Size, mOffset);
+        mRing->Enter(false);
+
+        mOffset += slot.Size;
+
+        // Wait until next buffer is free.
+        mCurrent = (mCurrent + 1) % mOptions.Depth;
+
+        while (mSlots[mCurrent].Pending)
+        {
+            Complete();
+        }
+    }
+
+    void Writer::Complete()
+    {
+        auto completion = mRing->Wait();
+        auto& done = mSlots[completion.UserData];
+
+        auto written = completion.Result < 0 ? 0 : static_cast<size_t>(completion.Result);
+        auto error = completion.Result < 0 ? -completion.Result : 0;
+
+        // Write of nothing won't make progress on retry, there's no room.
+        if (completion.Result == 0)
+        {
+            error = ENOSPC;
+        }
+
+        // Short write, rest is written synchronously.
+        while (!error && written < done.Size)
+        {
+            auto result = ::pwrite(mDescriptor, done.Data + written, done.Size - written, done.Offset + written);
+            if (result < 0 && errno != EINTR)
+            {
+                error = errno;
+            }
+            else if (result == 0)
+            {
+                error = ENOSPC;
+            }
+            else if (result > 0)
+            {
+                written += result;
+            }
+        }
+
+        done.Pending = false;
+        done.Size = 0;
+
+        if (error)
+        {
+            throw Error("Writing failed", error);
+        }
+    }
+
+    void Writer::Drain()
+    {
+        mRing->Enter(false);
+
+        for (unsigned i = 0; i < mOptions.Depth; ++i)
+        {
+            while (mSlots[i].Pending)
+            {
+                Complete();
+            }
+        }
+    }
+}
+
+#else
+
+namespace Uring
+{
+    class Ring
+    {
+    };
+
+    struct Reader::Slot
+    {
+    };
+
+    struct Writer::Slot
+    {
+    };
+
+    bool Available()
+    {
+        return false;
+    }
+
+    Reader::Reader(const std::string&, const Options&)
+    {
+        throw std::runtime_error("Uring: Not supported on this platform.");
+    }
+
+    Reader::~Reader() = default;
+
+    bool Reader::ReadTo(TBuffer*)
+    {
+        return false;
+    }
+
+    size_t Reader::Read(char*, size_t)
+    {
+        return 0;
+    }
+
+    void Reader::Reset()
+    {
+    }
+
+    size_t Reader::ReadAt(size_t, char*, size_t)
+    {
+        return 0;
+    }
+
+    size_t Reader::Size()
+    {
+        return 0;
+    }
+
+    Writer::Writer(const std::string&, const Options&)
+    {
+        throw std::runtime_error("Uring: Not supported on this platform.");
+    }
+
+    Writer::~Writer() = default;
+
+    void Writer::Write(const char*, size_t)
+    {
+    }
+
+    void Writer::Skip(const size_t)
+    {
+    }
+
+    void Writer::Reset()
+    {
+    }
+
+    void Writer::Close()
+    {
+    }
+
+    void Writer::Complete()
+    {
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Interfaces.hpp"
+
+namespace Uring
+{
+    struct Options
+    {
+        // Requests in flight and size of each of them.
+        unsigned Depth{4};
+        size_t BlockSize{1024 * 1024};
+
+        // Bypass page cache on reading, if file system allows.
+        bool Direct{false};
+    };
+
+    // Whether kernel supports io_uring.
+    bool Available();
+
+    class Ring;
+
+    // Reads ahead with several large requests in flight,
+    // into buffers registered with kernel.
+    struct Reader final : IStorage::Input
+    {
+        Reader(const std::string& aName, const Options& aOptions = {});
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        Reader(Reader&&) = delete;
+
+        virtual bool ReadTo(TBuffer* aBuffer) override;
+        virtual size_t Read(char* aBuffer, size_t aSize) override;
+        virtual void Reset() override;
+        virtual size_t ReadAt(size_t aOffset, char* aBuffer, size_t aSize) override;
+        virtual size_t Size() override;
+
+    private:
+        struct Slot;
+
+        void Submit(Slot& aSlot);
+        Slot* Current();
+        void Drain();
+
+    private:
+        Options mOptions;
+
+        int mDescriptor{-1};
+        int mRandomAccessDescriptor{-1};
+        size_t mSize{0};
+
+        std::unique_ptr<Ring> mRing;
+        std::unique_ptr<Slot[]> mSlots;
+
+        size_t mNextOffset{0};
+        size_t mCurrent{0};
+        size_t mPosition{0};
+    };
+
+    // Submits full buffers and returns without waiting for them.
+    struct Writer final : IStorage::Output
+    {
+        Writer(const std::string& aName, const Options& aOptions = {});
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+        Writer(Writer&&) = delete;
+
+        virtual void Write(const char* aBuffer, size_t aSize) override;
+        virtual void Skip(const size_t aSize) override;
+        virtual void Reset() override;
+
+        // Waits for all writes, throws if any of them failed.
+        void Close();
+
+    private:
+        struct Slot;
+
+        void Submit();
+        void Complete();
+        void Drain();
+
+    private:
+        Options mOptions;
+
+        int mDescriptor{-1};
+
+        std::unique_ptr<Ring> mRing;
+        std::unique_ptr<Slot[]> mSlots;
+
+        size_t mCurrent{0};
+        size_t mOffset{0};
+    };
+}
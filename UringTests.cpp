@@ -0,0 +1,174 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include <unistd.h>
+
+#include "Processor.hpp"
+#include "Uring.hpp"
+#include "TestsBase.hpp"
+
+struct TemporaryFile
+{
+    TemporaryFile()
+      : Name{std::string{"/tmp/huffman-uring-"} + std::to_string(reinterpret_cast<uintptr_t>(this))}
+    {
+    }
+
+    ~TemporaryFile()
+    {
+        std::remove(Name.c_str());
+    }
+
+    std::string Content() const
+    {
+        std::ifstream stream{Name, std::ios::binary};
+        return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+    }
+
+    void Store(const std::string& aContent) const
+    {
+        std::ofstream stream{Name, std::ios::binary};
+        stream << aContent;
+    }
+
+    const std::string Name;
+};
+
+std::string MakeContent(size_t aSize)
+{
+    std::string content(aSize, '\0');
+    for (size_t i = 0; i < aSize; ++i)
+    {
+        content[i] = static_cast<char>(i * 31 % 253);
+    }
+    return content;
+}
+
+Uring::Options SmallBlocks()
+{
+    Uring::Options options;
+    options.Depth = 3;
+    options.BlockSize = 4096;
+    return options;
+}
+
+TEST(Uring, ShouldReadAheadWholeFile)
+{
+    if (!Uring::Available())
+    {
+        GTEST_SKIP();
+    }
+
+    TemporaryFile file;
+    auto content = MakeContent(100000);
+    file.Store(content);
+
+    Uring::Reader reader{file.Name, SmallBlocks()};
+    EXPECT_EQ(content.size(), reader.Size());
+
+    std::string actual;
+    IStorage::Input::TBuffer buffer;
+    while (reader.ReadTo(&buffer))
+    {
+        actual.append(buffer.begin(), buffer.end());
+    }
+    EXPECT_EQ(content, actual);
+
+    // Read again in chunks which don't match blocks.
+    reader.Reset();
+
+    actual.clear();
+    char chunk[1000];
+    while (auto count = reader.Read(chunk, sizeof(chunk)))
+    {
+        actual.append(chunk, count);
+    }
+    EXPECT_EQ(content, actual);
+
+    ASSERT_EQ(sizeof(chunk), reader.ReadAt(50000, chunk, sizeof(chunk)));
+    EXPECT_EQ(content.substr(50000, sizeof(chunk)), std::string(chunk, sizeof(chunk)));
+}
+
+TEST(Uring, ShouldWriteWithSkipAndReset)
+{
+    if (!Uring::Available())
+    {
+        GTEST_SKIP();
+    }
+
+    TemporaryFile file;
+    auto content = MakeContent(20000);
+
+    {
+        Uring::Writer writer{file.Name, SmallBlocks()};
+        writer.Skip(4);
+        writer.Write(content.data() + 4, content.size() - 4);
+        writer.Reset();
+        writer.Write(content.data(), 4);
+        writer.Close();
+    }
+
+    EXPECT_EQ(content, file.Content());
+}
+
+TEST(Uring, ShouldEncodeAndDecode)
+{
+    if (!Uring::Available())
+    {
+        GTEST_SKIP();
+    }
+
+    TemporaryFile source;
+    TemporaryFile encoded;
+    TemporaryFile decoded;
+
+    auto content = MakeContent(300000);
+    source.Store(content);
+
+    {
+        Uring::Reader reader{source.Name, SmallBlocks()};
+        Uring::Writer writer{encoded.Name, SmallBlocks()};
+        Processor::Encode(reader, writer);
+        writer.Close();
+    }
+
+    {
+        Uring::Reader reader{encoded.Name, SmallBlocks()};
+        Uring::Writer writer{decoded.Name, SmallBlocks()};
+        Processor::Decode(reader, writer);
+        writer.Close();
+    }
+
+    EXPECT_EQ(content, decoded.Content());
+}
+
+TEST(Uring, ShouldCloseFileIfRingFails)
+{
+    if (!Uring::Available())
+    {
+        GTEST_SKIP();
+    }
+
+    TemporaryFile file;
+    file.Store(MakeContent(100));
+
+    Uring::Options options;
+    options.Depth = 0;
+
+    // Lowest free descriptor is the same, if none is left open.
+    auto free = [] {
+        auto descriptor = ::dup(0);
+        ::close(descriptor);
+        return descriptor;
+    };
+    auto before = free();
+
+    options.Direct = true;
+    EXPECT_THROW(Uring::Reader(file.Name, options), std::exception);
+    options.Direct = false;
+    EXPECT_THROW(Uring::Reader(file.Name, options), std::exception);
+    EXPECT_THROW(Uring::Writer(file.Name, options), std::exception);
+
+    EXPECT_EQ(before, free());
+}
@@ -0,0 +1,79 @@
+/*
+ * C interface of Huffman codec.
+ *
+ * Buffer functions use the same format as 'encode' and 'decode' tools.
+ * Streaming contexts use block stream format, where each flush makes
+ * a block, which receiver may decode without waiting for more data.
+ *
+ * Functions return HUFFMAN_OK or negative error code. Message of the last
+ * error of calling thread is given by huffman_last_error().
+ */
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include <stddef.h>
+
+#if defined(_WIN32) && defined(HUFFMAN_SHARED)
+#define HUFFMAN_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#define HUFFMAN_API __attribute__((visibility("default")))
+#else
+#define HUFFMAN_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum huffman_status
+{
+    HUFFMAN_OK = 0,
+    HUFFMAN_ERROR_ARGUMENT = -1,
+    HUFFMAN_ERROR_BUFFER_TOO_SMALL = -2,
+    HUFFMAN_ERROR_DATA = -3,
+    HUFFMAN_ERROR_MEMORY = -4,
+    HUFFMAN_ERROR_STATE = -5,
+    HUFFMAN_ERROR_INTERNAL = -6
+} huffman_status;
+
+HUFFMAN_API const char* huffman_status_string(huffman_status status);
+HUFFMAN_API const char* huffman_last_error(void);
+
+/* Encoded size never exceeds this bound. */
+HUFFMAN_API size_t huffman_encode_bound(size_t size);
+
+/* If destination is too small, required size is stored to dst_size. */
+HUFFMAN_API huffman_status huffman_encode(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                                          size_t* dst_size);
+
+HUFFMAN_API huffman_status huffman_decoded_size(const void* src, size_t src_size, size_t* size);
+
+HUFFMAN_API huffman_status huffman_decode(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                                          size_t* dst_size);
+
+/* Streaming encoder keeps encoded data until it is read. */
+typedef struct huffman_encoder huffman_encoder;
+
+/* Zero block size means default one. */
+HUFFMAN_API huffman_status huffman_encoder_create(size_t block_size, huffman_encoder** encoder);
+HUFFMAN_API huffman_status huffman_encoder_feed(huffman_encoder* encoder, const void* data, size_t size);
+HUFFMAN_API huffman_status huffman_encoder_flush(huffman_encoder* encoder);
+HUFFMAN_API huffman_status huffman_encoder_finish(huffman_encoder* encoder);
+HUFFMAN_API size_t huffman_encoder_pending(const huffman_encoder* encoder);
+HUFFMAN_API huffman_status huffman_encoder_read(huffman_encoder* encoder, void* dst, size_t capacity, size_t* size);
+HUFFMAN_API void huffman_encoder_destroy(huffman_encoder* encoder);
+
+/* Streaming decoder takes input split at any byte. */
+typedef struct huffman_decoder huffman_decoder;
+
+HUFFMAN_API huffman_status huffman_decoder_create(huffman_decoder** decoder);
+HUFFMAN_API huffman_status huffman_decoder_feed(huffman_decoder* decoder, const void* src, size_t src_size,
+                                                size_t* consumed, void* dst, size_t dst_capacity, size_t* produced);
+HUFFMAN_API int huffman_decoder_finished(const huffman_decoder* decoder);
+HUFFMAN_API void huffman_decoder_destroy(huffman_decoder* decoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif